@@ -0,0 +1,96 @@
+/**
+ * @file Benchmark.hpp
+ * @brief Minimal benchmark harness for the RaeptorCogs benchmarks.
+ *
+ * Benchmarks register themselves with RAEPTORCOGS_BENCHMARK and time their hot
+ * section with State::measure. The runner prints the min and median of each case.
+ */
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace RaeptorCogs::Benchmark {
+
+/**
+ * @brief Timing state passed to a benchmark.
+ */
+class State {
+    private:
+        size_t iterations;
+        std::vector<double> samples;
+
+    public:
+        explicit State(size_t iterations) : iterations(iterations) {}
+
+        /**
+         * @brief Time body, running setup untimed before each iteration.
+         *
+         * @param label Name printed for this measurement.
+         * @param setup Untimed callable run before each iteration.
+         * @param body Timed callable.
+         */
+        template<typename Setup, typename Body>
+        void measure(const std::string& label, Setup&& setup, Body&& body) {
+            samples.clear();
+            for (size_t i = 0; i < iterations; ++i) {
+                setup();
+                auto start = std::chrono::steady_clock::now();
+                body();
+                auto end = std::chrono::steady_clock::now();
+                samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+            std::sort(samples.begin(), samples.end());
+            std::printf("  %-48s min %10.4f ms   median %10.4f ms\n",
+                label.c_str(), samples.front(), samples[samples.size() / 2]);
+        }
+
+        /**
+         * @brief Time body without per-iteration setup.
+         *
+         * @param label Name printed for this measurement.
+         * @param body Timed callable.
+         */
+        template<typename Body>
+        void measure(const std::string& label, Body&& body) {
+            this->measure(label, [] {}, std::forward<Body>(body));
+        }
+};
+
+/**
+ * @brief Registered benchmark case.
+ */
+struct Case {
+    const char* name;
+    void (*function)(State&);
+};
+
+/**
+ * @brief Get the list of registered benchmarks.
+ */
+inline std::vector<Case>& Registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+/**
+ * @brief Register a benchmark.
+ */
+inline bool Register(const char* name, void (*function)(State&)) {
+    Registry().push_back({name, function});
+    return true;
+}
+
+}
+
+/**
+ * @brief Define and register a benchmark case.
+ */
+#define RAEPTORCOGS_BENCHMARK(name) \
+    static void name(RaeptorCogs::Benchmark::State& state); \
+    static const bool name##_registered = RaeptorCogs::Benchmark::Register(#name, name); \
+    static void name(RaeptorCogs::Benchmark::State& state)
@@ -0,0 +1,115 @@
+#include "Benchmark.hpp"
+#include <RaeptorCogs/Node.hpp>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+using namespace RaeptorCogs;
+
+namespace {
+
+// Keeps the query results from being optimized away
+volatile size_t sink = 0;
+
+// Previous scheme: every level rebuilds the class IDs into a fresh BitArray
+struct LegacyNode {
+    virtual ~LegacyNode() = default;
+    virtual BitArray getClassIds() const {
+        BitArray classIds;
+        return classIds.set(Node::getClassId<LegacyNode>());
+    }
+    template<typename T>
+    bool isInstanceOf() const {
+        return this->getClassIds().test(Node::getClassId<T>());
+    }
+};
+
+template<typename Derived, typename Base>
+struct LegacyRegisterNode : Base {
+    BitArray getClassIds() const override {
+        BitArray bits = Base::getClassIds();
+        bits.set(Node::getClassId<Derived>());
+        return bits;
+    }
+};
+
+// Same depth as Graphic2D, RenderableGraphic2D and TransformableGraphic2D
+struct LegacyGraphic : LegacyRegisterNode<LegacyGraphic, LegacyNode> {};
+struct LegacyRenderable : LegacyRegisterNode<LegacyRenderable, LegacyGraphic> {};
+struct LegacyTransformable : LegacyRegisterNode<LegacyTransformable, LegacyRenderable> {};
+
+struct Graphic : RegisterNode<Graphic, Node> {};
+struct Renderable : RegisterNode<Renderable, Graphic> {};
+struct Transformable : RegisterNode<Transformable, Renderable> {};
+
+template<typename Root, typename... Types>
+std::vector<std::unique_ptr<Root>> makeNodes(size_t count) {
+    std::mt19937 rng(24);
+    std::vector<std::unique_ptr<Root>> nodes;
+    nodes.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t type = rng() % sizeof...(Types);
+        size_t index = 0;
+        ((type == index++ ? (nodes.push_back(std::make_unique<Types>()), 0) : 0), ...);
+    }
+    return nodes;
+}
+
+void runIsInstanceOf(Benchmark::State& state, size_t count) {
+    auto legacyNodes = makeNodes<LegacyNode, LegacyNode, LegacyGraphic, LegacyRenderable, LegacyTransformable>(count);
+    auto nodes = makeNodes<Node, Node, Graphic, Renderable, Transformable>(count);
+
+    state.measure("BitArray built per query", [&] {
+        size_t hits = 0;
+        for (auto& node : legacyNodes) hits += node->isInstanceOf<LegacyRenderable>();
+        sink = hits;
+    });
+
+    state.measure("Class mask built once per class", [&] {
+        size_t hits = 0;
+        for (auto& node : nodes) hits += node->isInstanceOf<Renderable>();
+        sink = hits;
+    });
+}
+
+// Previous scheme: children kept in a vector, removal finds then erases
+struct LegacyParent {
+    std::vector<LegacyParent*> children;
+    LegacyParent* parent = nullptr;
+    void addChild(LegacyParent* child) {
+        children.push_back(child);
+        child->parent = this;
+    }
+    void removeChild(LegacyParent* child) {
+        auto it = std::find(children.begin(), children.end(), child);
+        if (it != children.end()) {
+            children.erase(it);
+            child->parent = nullptr;
+        }
+    }
+};
+
+// Fills a parent then empties it in insertion order, as a text does with its glyphs
+void runRemoveChild(Benchmark::State& state, size_t count) {
+    std::vector<LegacyParent> legacyChildren(count);
+    LegacyParent legacyRoot;
+    std::vector<Node> children(count);
+    Node root;
+
+    state.measure("Vector find and erase", [&] {
+        for (LegacyParent& child : legacyChildren) legacyRoot.addChild(&child);
+        for (LegacyParent& child : legacyChildren) legacyRoot.removeChild(&child);
+        sink = legacyRoot.children.size();
+    });
+
+    state.measure("Intrusive sibling links", [&] {
+        for (Node& child : children) root.addChild(&child);
+        for (Node& child : children) root.removeChild(&child);
+        sink = root.getChildren().size();
+    });
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(IsInstanceOf_1M) { runIsInstanceOf(state, 1000000); }
+RAEPTORCOGS_BENCHMARK(RemoveChild_50K) { runRemoveChild(state, 50000); }
@@ -0,0 +1,34 @@
+#include "Benchmark.hpp"
+#include <RaeptorCogs/PagedBuffer.hpp>
+#include <vector>
+
+using namespace RaeptorCogs;
+
+namespace {
+
+// Same size as the full StaticInstanceData
+struct alignas(16) Instance {
+    float values[24];
+};
+
+void runSpawn(Benchmark::State& state, size_t count) {
+    // Previous behaviour: one resize per spawned graphic, reallocating and copying as it grows
+    std::vector<Instance> flat;
+    state.measure("std::vector resize per spawn", [&] { flat = std::vector<Instance>(); }, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            flat.resize(flat.size() + 1);
+        }
+    });
+
+    PagedBuffer<Instance> paged;
+    state.measure("PagedBuffer resize per spawn", [&] { paged.clear(); }, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            paged.resize(paged.size() + 1);
+        }
+    });
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(Spawn_100K) { runSpawn(state, 100000); }
+RAEPTORCOGS_BENCHMARK(Spawn_1M) { runSpawn(state, 1000000); }
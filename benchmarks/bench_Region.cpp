@@ -0,0 +1,106 @@
+#include "Benchmark.hpp"
+#include <RaeptorCogs/Region.hpp>
+#include <memory>
+#include <numeric>
+#include <random>
+
+using namespace RaeptorCogs;
+
+namespace {
+
+// Instance slots marked dirty by a frame animating part of the scene, in render order
+std::vector<size_t> pickDirtySlots(size_t sceneSize, size_t count) {
+    std::vector<size_t> slots(sceneSize);
+    std::iota(slots.begin(), slots.end(), size_t{0});
+    std::shuffle(slots.begin(), slots.end(), std::mt19937(3));
+    slots.resize(count);
+    return slots;
+}
+
+void runCoalesce(Benchmark::State& state, size_t sceneSize, size_t dirtyCount) {
+    auto slots = pickDirtySlots(sceneSize, dirtyCount);
+
+    RegionBuffer buffer;
+    state.measure("RegionBuffer::push per handler", [&] { buffer.clear(); }, [&] {
+        for (size_t slot : slots) buffer.push(slot, slot + 1);
+    });
+
+    std::vector<Region> regions;
+    state.measure("append + CoalesceRegions", [&] { regions.clear(); }, [&] {
+        for (size_t slot : slots) regions.emplace_back(slot, slot + 1);
+        CoalesceRegions(regions, 170);
+    });
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(DirtyRegions_1K_Of_100K) { runCoalesce(state, 100000, 1000); }
+RAEPTORCOGS_BENCHMARK(DirtyRegions_10K_Of_100K) { runCoalesce(state, 100000, 10000); }
+RAEPTORCOGS_BENCHMARK(DirtyRegions_100K_Of_1M) { runCoalesce(state, 1000000, 100000); }
+
+namespace {
+
+// Previous RegionAllocator: first-fit scan over a sorted RegionBuffer
+class FirstFitAllocator : public RegionBuffer {
+    public:
+        size_t allocate(size_t size) {
+            for (auto region : *this) {
+                if (region.second - region.first >= size) {
+                    this->erase(region.first, region.first + size);
+                    return region.first;
+                }
+            }
+            return SIZE_MAX;
+        }
+        void free(size_t begin, size_t end) { this->push(begin, end); }
+};
+
+// Glyphs (4 floats) and sprites (3 floats): half of the scene freed, then freed and respawned
+template<typename Allocator>
+void runChurn(Benchmark::State& state, const std::string& label, size_t sceneSize, size_t churnCount) {
+    std::mt19937 rng(17);
+    std::vector<Region> live;
+    std::unique_ptr<Allocator> allocator;
+    size_t end = 0;
+
+    state.measure(label, [&] {
+        allocator = std::make_unique<Allocator>();
+        live.clear();
+        end = 0;
+        for (size_t i = 0; i < sceneSize; ++i) {
+            size_t size = 3 + rng() % 2;
+            live.emplace_back(end, end + size);
+            end += size;
+        }
+        std::shuffle(live.begin(), live.end(), rng);
+        for (size_t i = 0; i < sceneSize / 2; ++i) {
+            allocator->free(live.back().first, live.back().second);
+            live.pop_back();
+        }
+    }, [&] {
+        for (size_t i = 0; i < churnCount; ++i) {
+            size_t pick = rng() % live.size();
+            Region region = live[pick];
+            allocator->free(region.first, region.second);
+            size_t size = 3 + rng() % 2;
+            size_t offset = allocator->allocate(size);
+            if (offset == SIZE_MAX) {
+                offset = end;
+                end += size;
+            }
+            live[pick] = Region(offset, offset + size);
+        }
+    });
+}
+
+void runChurn(Benchmark::State& state, size_t sceneSize, size_t churnCount, bool withLegacy) {
+    if (withLegacy) {
+        runChurn<FirstFitAllocator>(state, "first-fit RegionBuffer", sceneSize, churnCount);
+    }
+    runChurn<RegionAllocator>(state, "RegionAllocator (TLSF)", sceneSize, churnCount);
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(AllocatorChurn_10K_In_100K) { runChurn(state, 100000, 10000, true); }
+RAEPTORCOGS_BENCHMARK(AllocatorChurn_100K_In_1M) { runChurn(state, 1000000, 100000, false); }
@@ -0,0 +1,208 @@
+#include "Benchmark.hpp"
+#include <RaeptorCogs/GAPI/Common/Core/RenderList.hpp>
+#include <memory>
+#include <numeric>
+#include <random>
+
+using namespace RaeptorCogs;
+using namespace RaeptorCogs::GAPI::Common;
+
+namespace {
+
+BatchBuffer makeSortedBatch(size_t count) {
+    BatchBuffer batch;
+    batch.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        batch.emplace_back(BatchKey(false, 0, static_cast<float>(i), false, 0, 1), nullptr);
+    }
+    return batch;
+}
+
+std::vector<unsigned int> pickVictims(size_t sceneSize, size_t count) {
+    std::vector<unsigned int> victims(sceneSize);
+    std::iota(victims.begin(), victims.end(), 0u);
+    std::shuffle(victims.begin(), victims.end(), std::mt19937(11));
+    victims.resize(count);
+    return victims;
+}
+
+void runRemove(Benchmark::State& state, size_t sceneSize, size_t removeCount, bool withLegacy) {
+    BatchBuffer batch = makeSortedBatch(sceneSize);
+    auto victims = pickVictims(sceneSize, removeCount);
+
+    if (withLegacy) {
+        // Previous behaviour: one std::remove over the order indices per erased handler
+        OrderIndicesBuffer order;
+        state.measure("std::remove per handler", [&] {
+            order.resize(sceneSize);
+            std::iota(order.begin(), order.end(), 0u);
+        }, [&] {
+            for (unsigned int index : victims) {
+                order.erase(std::remove(order.begin(), order.end(), index), order.end());
+            }
+        });
+    }
+
+    std::unique_ptr<RenderList> list;
+    state.measure("RenderList::remove + compact", [&] {
+        list = std::make_unique<RenderList>(batch);
+        for (unsigned int i = 0; i < sceneSize; ++i) list->insert(i);
+    }, [&] {
+        for (unsigned int index : victims) {
+            list->remove(index);
+        }
+        list->compact();
+    });
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(Remove_10K_From_100K) { runRemove(state, 100000, 10000, true); }
+RAEPTORCOGS_BENCHMARK(Remove_100K_From_1M) { runRemove(state, 1000000, 100000, false); }
+
+namespace {
+
+void runReorder(Benchmark::State& state, size_t sceneSize) {
+    BatchBuffer batch = makeSortedBatch(sceneSize);
+    std::unique_ptr<RenderList> list = std::make_unique<RenderList>(batch);
+    for (unsigned int i = 0; i < sceneSize; ++i) list->insert(i);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> z(0.0f, static_cast<float>(sceneSize));
+
+    for (size_t dirtyCount : {1u, 8u, 32u, 128u, 1024u}) {
+        if (dirtyCount > sceneSize / 4) break;
+        state.measure("reorder(), " + std::to_string(dirtyCount) + " dirty", [&] {
+            for (size_t i = 0; i < dirtyCount; ++i) {
+                size_t index = rng() % sceneSize;
+                batch.getKey(index) = BatchKey(false, 0, z(rng), false, 0, 1);
+                list->markDirty(batch[index]);
+            }
+        }, [&] {
+            list->reorder();
+        });
+    }
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(Reorder_10K) { runReorder(state, 10000); }
+RAEPTORCOGS_BENCHMARK(Reorder_100K) { runReorder(state, 100000); }
+RAEPTORCOGS_BENCHMARK(Reorder_1M) { runReorder(state, 1000000); }
+
+namespace {
+
+void runReorderFraction(Benchmark::State& state, size_t sceneSize) {
+    BatchBuffer batch = makeSortedBatch(sceneSize);
+    std::unique_ptr<RenderList> list = std::make_unique<RenderList>(batch);
+    for (unsigned int i = 0; i < sceneSize; ++i) list->insert(i);
+    std::mt19937 rng(6);
+    std::uniform_real_distribution<float> z(0.0f, static_cast<float>(sceneSize));
+
+    for (int percent : {1, 10, 30, 50, 80}) {
+        size_t dirtyCount = sceneSize * static_cast<size_t>(percent) / 100;
+        state.measure("reorder(), " + std::to_string(percent) + "% dirty", [&] {
+            for (size_t i = 0; i < dirtyCount; ++i) {
+                size_t index = rng() % sceneSize;
+                batch.getKey(index) = BatchKey(false, 0, z(rng), false, 0, 1);
+                list->markDirty(batch[index]);
+            }
+        }, [&] {
+            list->reorder();
+        });
+    }
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(ReorderFraction_100K) { runReorderFraction(state, 100000); }
+RAEPTORCOGS_BENCHMARK(ReorderFraction_1M) { runReorderFraction(state, 1000000); }
+
+namespace {
+
+void runBuildDrawCommands(Benchmark::State& state, size_t sceneSize) {
+    // Runs of 8 instances per texture, 16 textures cycling along z
+    BatchBuffer batch;
+    batch.reserve(sceneSize);
+    for (size_t i = 0; i < sceneSize; ++i) {
+        batch.emplace_back(BatchKey(false, 0, static_cast<float>(i / 64), false, 0, static_cast<uint32_t>(1 + (i / 8) % 16)), nullptr);
+    }
+    std::unique_ptr<RenderList> list = std::make_unique<RenderList>(batch);
+    for (unsigned int i = 0; i < sceneSize; ++i) list->insert(i);
+    list->reorder();
+
+    state.measure("buildDrawCommands()", [] {}, [&] {
+        list->buildDrawCommands([](const BatchKey& a, const BatchKey& b) {
+            return a.matches(b, BatchKey::TEXTURE_FIELD | BatchKey::WRITING_FIELD);
+        });
+    });
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(BuildDrawCommands_100K) { runBuildDrawCommands(state, 100000); }
+RAEPTORCOGS_BENCHMARK(BuildDrawCommands_1M) { runBuildDrawCommands(state, 1000000); }
+
+namespace {
+
+void runReorderNearlySorted(Benchmark::State& state, size_t sceneSize) {
+    BatchBuffer batch = makeSortedBatch(sceneSize);
+    std::unique_ptr<RenderList> list = std::make_unique<RenderList>(batch);
+    for (unsigned int i = 0; i < sceneSize; ++i) list->insert(i);
+    std::mt19937 rng(9);
+    // Small z changes around the handler's own z, a few slots of displacement
+    std::uniform_real_distribution<float> jitter(-4.0f, 4.0f);
+
+    for (size_t dirtyCount : {64u, 1024u, 10000u, 100000u}) {
+        if (dirtyCount > sceneSize / 4) break;
+        state.measure("reorder(), " + std::to_string(dirtyCount) + " nudged", [&] {
+            for (size_t i = 0; i < dirtyCount; ++i) {
+                size_t index = rng() % sceneSize;
+                batch.getKey(index) = BatchKey(false, 0, static_cast<float>(index) + jitter(rng), false, 0, 1);
+                list->markDirty(batch[index]);
+            }
+        }, [&] {
+            list->reorder();
+        });
+    }
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(ReorderNearlySorted_100K) { runReorderNearlySorted(state, 100000); }
+RAEPTORCOGS_BENCHMARK(ReorderNearlySorted_1M) { runReorderNearlySorted(state, 1000000); }
+
+namespace {
+
+void runLayerSwitch(Benchmark::State& state, size_t sceneSize) {
+    // Background, world, FX and UI layers of 16 textures each
+    BatchBuffer batch;
+    batch.reserve(sceneSize);
+    for (size_t i = 0; i < sceneSize; ++i) {
+        batch.emplace_back(BatchKey(false, 0, static_cast<float>(i % 4), false, 0, static_cast<uint32_t>(1 + i % 16)), nullptr);
+    }
+
+    for (bool bucketed : {false, true}) {
+        std::unique_ptr<RenderList> list = std::make_unique<RenderList>(batch);
+        for (unsigned int i = 0; i < sceneSize; ++i) list->insert(i);
+        list->reorder();
+        list->setBucketed(bucketed);
+        std::mt19937 rng(13);
+
+        for (size_t dirtyCount : {1u, 64u, 1024u}) {
+            state.measure(std::string(bucketed ? "bucketed" : "sorted") + " reorder(), " + std::to_string(dirtyCount) + " layer switches", [&] {
+                for (size_t i = 0; i < dirtyCount; ++i) {
+                    size_t index = rng() % sceneSize;
+                    batch.getKey(index) = BatchKey(false, 0, static_cast<float>(rng() % 4), false, 0, static_cast<uint32_t>(1 + index % 16));
+                    list->markDirty(batch[index]);
+                }
+            }, [&] {
+                list->reorder();
+            });
+        }
+    }
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(LayerSwitch_100K) { runLayerSwitch(state, 100000); }
+RAEPTORCOGS_BENCHMARK(LayerSwitch_1M) { runLayerSwitch(state, 1000000); }
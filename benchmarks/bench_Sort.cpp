@@ -0,0 +1,80 @@
+#include "Benchmark.hpp"
+#include <RaeptorCogs/GAPI/Common/Core/BatchBuffer.hpp>
+#include <RaeptorCogs/Sort.hpp>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+using namespace RaeptorCogs;
+using RaeptorCogs::GAPI::Common::BatchBuffer;
+
+namespace {
+
+// Sprite-like distribution: spread z, a handful of atlases, few masked graphics
+BatchBuffer makeBatch(size_t count) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> z(-1000.0f, 1000.0f);
+    std::uniform_int_distribution<uint32_t> texture(1, 16);
+    std::uniform_int_distribution<int> masked(0, 99);
+
+    BatchBuffer batch;
+    batch.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        bool writing = masked(rng) == 0;
+        BatchKey key(writing, writing ? 1 : 0, z(rng), !writing && masked(rng) < 50, 0, texture(rng));
+        batch.emplace_back(key, nullptr);
+    }
+    return batch;
+}
+
+void checkSorted(const BatchBuffer& batch, const std::vector<unsigned int>& order) {
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (batch.getKey(order[i]) < batch.getKey(order[i - 1])) {
+            throw std::runtime_error("Order indices are not sorted");
+        }
+    }
+}
+
+void runFullReorder(Benchmark::State& state, size_t count) {
+    auto batch = makeBatch(count);
+    std::vector<unsigned int> shuffled(count);
+    std::iota(shuffled.begin(), shuffled.end(), 0u);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(7));
+    std::vector<unsigned int> order;
+
+    state.measure("std::sort (BatchKey::operator<)", [&] { order = shuffled; }, [&] {
+        std::sort(order.begin(), order.end(), [&batch](size_t a, size_t b) {
+            return batch.getKey(a) < batch.getKey(b);
+        });
+    });
+    checkSorted(batch, order);
+
+    RadixSorter sorter;
+    sorter.setThreadCount(1);
+    state.measure("RadixSorter (BatchKey::getSortKey)", [&] { order = shuffled; }, [&] {
+        sorter.sort(order, [&batch](unsigned int index) {
+            return batch.getKey(index).getSortKey();
+        });
+    });
+    checkSorted(batch, order);
+
+    for (unsigned int threads : {2u, 4u, 8u, 16u}) {
+        if (count < RadixSorter::PARALLEL_THRESHOLD) break;
+        RadixSorter parallelSorter;
+        parallelSorter.setThreadCount(threads);
+        state.measure("RadixSorter x" + std::to_string(threads) + " threads", [&] { order = shuffled; }, [&] {
+            parallelSorter.sort(order, [&batch](unsigned int index) {
+                return batch.getKey(index).getSortKey();
+            });
+        });
+        checkSorted(batch, order);
+    }
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(FullReorder_1K) { runFullReorder(state, 1000); }
+RAEPTORCOGS_BENCHMARK(FullReorder_10K) { runFullReorder(state, 10000); }
+RAEPTORCOGS_BENCHMARK(FullReorder_100K) { runFullReorder(state, 100000); }
+RAEPTORCOGS_BENCHMARK(FullReorder_1M) { runFullReorder(state, 1000000); }
+RAEPTORCOGS_BENCHMARK(FullReorder_4M) { runFullReorder(state, 4000000); }
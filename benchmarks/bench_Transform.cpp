@@ -0,0 +1,138 @@
+#include "Benchmark.hpp"
+#include <RaeptorCogs/Transform.hpp>
+#include <memory>
+#include <random>
+#include <string>
+
+using namespace RaeptorCogs;
+
+namespace {
+
+// Keeps the matrix reads from being optimized away
+volatile float sink = 0.0f;
+
+// Previous TransformableGraphic2D: matrices rebuilt on demand, recursing up the parents
+struct LegacyNode {
+    TransformComponents components;
+    Affine2D local;
+    Affine2D global;
+    LegacyNode* parent = nullptr;
+    std::vector<LegacyNode*> children;
+    bool localDirty = true;
+    bool globalDirty = true;
+
+    void setGlobalDirty() {
+        globalDirty = true;
+        for (LegacyNode* child : children) child->setGlobalDirty();
+    }
+    void setPosition(const glm::vec2& position) {
+        components.position = position;
+        localDirty = true;
+        for (LegacyNode* child : children) child->setGlobalDirty();
+    }
+    const Affine2D& getModel() {
+        if (localDirty) local = ComposeLocalAffine(components);
+        if (localDirty || globalDirty) {
+            global = parent ? ComposeChildAffine(parent->getModel(), parent->components.size, parent->components.anchor, local) : local;
+            localDirty = false;
+            globalDirty = false;
+        }
+        return global;
+    }
+};
+
+// Trees of 100 nodes, each node under one of the 16 nodes created before it
+std::vector<uint32_t> makeParents(size_t sceneSize) {
+    std::mt19937 rng(21);
+    std::vector<uint32_t> parents(sceneSize, UINT32_MAX);
+    for (size_t i = 0; i < sceneSize; ++i) {
+        size_t offset = i % 100;
+        if (offset) parents[i] = static_cast<uint32_t>(i - 1 - rng() % std::min<size_t>(offset, 16));
+    }
+    return parents;
+}
+
+void runTransformUpdate(Benchmark::State& state, size_t sceneSize) {
+    std::vector<uint32_t> parents = makeParents(sceneSize);
+    std::mt19937 rng(22);
+
+    std::vector<std::unique_ptr<LegacyNode>> nodes;
+    for (size_t i = 0; i < sceneSize; ++i) {
+        nodes.push_back(std::make_unique<LegacyNode>());
+        nodes[i]->components.size = glm::vec2(2.0f, 2.0f);
+        if (parents[i] != UINT32_MAX) {
+            nodes[i]->parent = nodes[parents[i]].get();
+            nodes[parents[i]]->children.push_back(nodes[i].get());
+        }
+    }
+    TransformHierarchy hierarchy;
+    std::vector<TransformID> ids;
+    for (size_t i = 0; i < sceneSize; ++i) {
+        ids.push_back(hierarchy.create());
+        hierarchy.setSize(ids[i], glm::vec2(2.0f, 2.0f));
+        if (parents[i] != UINT32_MAX) hierarchy.setParent(ids[i], ids[parents[i]]);
+    }
+    hierarchy.update();
+
+    for (int percent : {1, 10, 100}) {
+        size_t movedCount = sceneSize * static_cast<size_t>(percent) / 100;
+        std::vector<size_t> moved(movedCount);
+        for (size_t& index : moved) index = rng() % sceneSize;
+
+        // Moving the graphics is part of the frame: the legacy nodes propagate their dirty flag
+        state.measure("on demand recursion, " + std::to_string(percent) + "% moved", [&] {
+            for (size_t index : moved) nodes[index]->setPosition(glm::vec2(static_cast<float>(rng() % 100), 0.0f));
+            float sum = 0.0f;
+            for (auto& node : nodes) sum += node->getModel().tx;
+            sink = sum;
+        });
+
+        state.measure("TransformHierarchy::update, " + std::to_string(percent) + "% moved", [&] {
+            for (size_t index : moved) hierarchy.setPosition(ids[index], glm::vec2(static_cast<float>(rng() % 100), 0.0f));
+            float sum = 0.0f;
+            for (TransformID id : ids) sum += hierarchy.getGlobal(id).tx;
+            sink = sum;
+        });
+    }
+}
+
+void runLocalAffines(Benchmark::State& state, size_t sceneSize) {
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (bool rotated : {false, true}) {
+        TransformComponentArrays arrays;
+        for (size_t i = 0; i < sceneSize; ++i) {
+            TransformComponents components;
+            components.position = glm::vec2(distribution(rng) * 500.0f, distribution(rng) * 500.0f);
+            components.size = glm::vec2(32.0f, 32.0f);
+            components.rotation = rotated ? distribution(rng) * 3.0f : 0.0f;
+            components.anchor = glm::vec2(0.5f, 0.5f);
+            arrays.push(components);
+        }
+        std::vector<Affine2D> locals(sceneSize);
+        const char* label = rotated ? "rotated" : "unrotated";
+
+        // Every other sprite moved, so the batches gather
+        for (size_t stride : {1, 2}) {
+            std::vector<uint32_t> indices;
+            for (size_t i = 0; i < sceneSize; i += stride) indices.push_back(static_cast<uint32_t>(i));
+            std::string suffix = std::string(label) + (stride == 1 ? ", all" : ", every other");
+
+            state.measure("ComposeLocalAffine one by one, " + suffix, [&] {
+                for (uint32_t index : indices) locals[index] = ComposeLocalAffine(arrays.get(index));
+                sink = locals[indices.back()].tx;
+            });
+
+            state.measure("ComposeLocalAffines, " + suffix, [&] {
+                ComposeLocalAffines(arrays, indices.data(), indices.size(), locals.data());
+                sink = locals[indices.back()].tx;
+            });
+        }
+    }
+}
+
+}
+
+RAEPTORCOGS_BENCHMARK(LocalAffines_1M) { runLocalAffines(state, 1000000); }
+RAEPTORCOGS_BENCHMARK(TransformUpdate_100K) { runTransformUpdate(state, 100000); }
+RAEPTORCOGS_BENCHMARK(TransformUpdate_1M) { runTransformUpdate(state, 1000000); }
@@ -0,0 +1,24 @@
+#include "Benchmark.hpp"
+#include <cstdlib>
+#include <cstring>
+
+// Usage: RaeptorCogs_benchmarks [filter] [--iterations N]
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    size_t iterations = 10;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    for (auto& benchmark : RaeptorCogs::Benchmark::Registry()) {
+        if (filter && std::strstr(benchmark.name, filter) == nullptr) continue;
+        std::printf("%s\n", benchmark.name);
+        RaeptorCogs::Benchmark::State state(iterations);
+        benchmark.function(state);
+    }
+    return 0;
+}
@@ -113,7 +113,7 @@ class BitArray {
          * 
          * @note Returns false if the index is out of bounds.
          */
-        bool test(size_t index) {
+        bool test(size_t index) const {
             size_t vecIndex = index / 64;
             size_t bitIndex = index % 64;
             if (vecIndex >= bits.size()) {
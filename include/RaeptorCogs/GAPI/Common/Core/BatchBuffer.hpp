@@ -0,0 +1,212 @@
+/** ********************************************************************************
+ * @section GAPI_Common_Core_BatchBuffer_Overview Overview
+ * @file BatchBuffer.hpp
+ * @brief Batch buffer storage.
+ * @details
+ * Typical use cases:
+ * - Storing the batch handlers of a render pipeline
+ * - Sorting and grouping handlers while touching only their batch keys
+ * *********************************************************************************
+ * @section GAPI_Common_Core_BatchBuffer_Header Header
+ * <RaeptorCogs/GAPI/Common/Core/BatchBuffer.hpp>
+ ***********************************************************************************
+ * @section GAPI_Common_Core_BatchBuffer_Metadata Metadata
+ * @author Estorc
+ * @version v1.0
+ * @copyright Copyright (c) 2025 Estorc MIT License.
+ **********************************************************************************/
+/*                             This file is part of
+ *                                  RaeptorCogs
+ *                     (https://github.com/Estorc/RaeptorCogs)
+ ***********************************************************************************
+ * Copyright (c) 2025 Estorc.
+ * This file is licensed under the MIT License.
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ***********************************************************************************/
+
+
+#pragma once
+#include <RaeptorCogs/GAPI/Common/Core/GraphicHandler.hpp>
+#include <vector>
+
+namespace RaeptorCogs::GAPI::Common {
+
+/**
+ * @brief Batch buffer class.
+ * 
+ * Holds the batch handlers of a render pipeline as parallel arrays: the batch keys,
+ * read by every sort, reorder and draw command pass, are kept apart from the cursors
+ * and graphic back-pointers only needed when instance data is computed or moved.
+ * 
+ * @code{.cpp}
+ * RaeptorCogs::GAPI::Common::BatchBuffer batch;
+ * auto& handler = batch.emplace_back(key, graphic);
+ * batch.getKey(batch.indexOf(handler)) = newKey;
+ * @endcode
+ * 
+ * @note Both arrays share the same indices, the batch index of a handler.
+ */
+class BatchBuffer {
+    private:
+
+        // ============================================================================
+        //                             PRIVATE MEMBERS
+        // ============================================================================
+
+        /**
+         * @brief Batch key of each handler.
+         */
+        std::vector<BatchKey> keys;
+
+        /**
+         * @brief Cursors, graphic and dirty flag of each handler.
+         */
+        std::vector<GraphicBatchHandler> handlers;
+
+    public:
+
+        // ============================================================================
+        //                             PUBLIC METHODS
+        // ============================================================================
+
+        /**
+         * @brief Get the number of handlers.
+         * 
+         * @return Number of handlers.
+         */
+        size_t size() const { return handlers.size(); }
+
+        /**
+         * @brief Check if the buffer holds no handler.
+         * 
+         * @return true if empty, false otherwise.
+         */
+        bool empty() const { return handlers.empty(); }
+
+        /**
+         * @brief Reserve room for handlers.
+         * 
+         * @param capacity Number of handlers to reserve room for.
+         */
+        void reserve(size_t capacity) {
+            keys.reserve(capacity);
+            handlers.reserve(capacity);
+        }
+
+        /**
+         * @brief Add a handler at the end of the buffer.
+         * 
+         * @param key Batch key of the handler.
+         * @param graphic Pointer to the associated graphic.
+         * @return Reference to the new handler.
+         */
+        GraphicBatchHandler& emplace_back(const BatchKey& key, Graphic2D* graphic) {
+            keys.push_back(key);
+            return handlers.emplace_back(graphic);
+        }
+
+        /**
+         * @brief Remove the last handler.
+         */
+        void pop_back() {
+            keys.pop_back();
+            handlers.pop_back();
+        }
+
+        /**
+         * @brief Remove the handlers past a size.
+         * 
+         * @param size Number of handlers to keep.
+         */
+        void truncate(size_t size) {
+            if (size >= handlers.size()) return;
+            keys.resize(size);
+            handlers.erase(handlers.begin() + static_cast<std::ptrdiff_t>(size), handlers.end());
+        }
+
+        /**
+         * @brief Remove every handler.
+         */
+        void clear() {
+            keys.clear();
+            handlers.clear();
+        }
+
+        /**
+         * @brief Copy a handler and its key to another index.
+         * 
+         * @param from Index of the handler to copy.
+         * @param to Index receiving the copy.
+         */
+        void move(size_t from, size_t to) {
+            keys[to] = keys[from];
+            handlers[to] = handlers[from];
+        }
+
+        /**
+         * @brief Get a handler.
+         * 
+         * @param index Batch index of the handler.
+         * @return Reference to the handler.
+         */
+        GraphicBatchHandler& operator[](size_t index) { return handlers[index]; }
+
+        /**
+         * @brief Get a handler (const version).
+         * 
+         * @param index Batch index of the handler.
+         * @return Const reference to the handler.
+         */
+        const GraphicBatchHandler& operator[](size_t index) const { return handlers[index]; }
+
+        /**
+         * @brief Get the batch key of a handler.
+         * 
+         * @param index Batch index of the handler.
+         * @return Reference to the batch key.
+         */
+        BatchKey& getKey(size_t index) { return keys[index]; }
+
+        /**
+         * @brief Get the batch key of a handler (const version).
+         * 
+         * @param index Batch index of the handler.
+         * @return Const reference to the batch key.
+         */
+        const BatchKey& getKey(size_t index) const { return keys[index]; }
+
+        /**
+         * @brief Get the batch keys of all handlers.
+         * 
+         * @return Pointer to the first batch key, indexed by batch index.
+         * 
+         * @note Invalidated when the buffer grows.
+         */
+        const BatchKey* getKeys() const { return keys.data(); }
+
+        /**
+         * @brief Get the batch index of a handler.
+         * 
+         * @param handler Reference to a handler of this buffer.
+         * @return Batch index of the handler.
+         */
+        size_t indexOf(const GraphicBatchHandler& handler) const {
+            return static_cast<size_t>(&handler - handlers.data());
+        }
+};
+
+}
@@ -41,7 +41,10 @@
 #include <iostream>
 #include <vector>
 #include <cstdint>
-#include <tuple>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 
 namespace RaeptorCogs {
     class Graphic2D;
@@ -50,61 +53,178 @@ namespace RaeptorCogs {
      * @brief Batch key structure.
      * 
      * Represents a unique key for graphic batching based on rendering parameters.
+     * 
+     * @note Packed into a single 64-bit integer whose ordering is the rendering order,
+     *       so comparing two keys is a single integer comparison. Layout from MSB:
+     *       writing (1), reading mask (11), z-index (32), opaque (1), program (3), texture slot (16).
+     *       Textures are keyed by a dense slot rather than their ID, see BatchKeySlots.
      */
     struct BatchKey {
+        /** Number of bits of the texture slot field. */
+        static constexpr unsigned int TEXTURE_BITS = 16;
+        /** Number of bits of the program field. */
+        static constexpr unsigned int PROGRAM_BITS = 3;
+        /** Number of bits of the opaque field. */
+        static constexpr unsigned int OPAQUE_BITS = 1;
+        /** Number of bits of the z-index field. */
+        static constexpr unsigned int ZINDEX_BITS = 32;
+        /** Number of bits of the reading mask field. */
+        static constexpr unsigned int READING_MASK_BITS = 11;
+
+        /** Offset of the texture field. */
+        static constexpr unsigned int TEXTURE_SHIFT = 0;
+        /** Offset of the program field. */
+        static constexpr unsigned int PROGRAM_SHIFT = TEXTURE_SHIFT + TEXTURE_BITS;
+        /** Offset of the opaque field. */
+        static constexpr unsigned int OPAQUE_SHIFT = PROGRAM_SHIFT + PROGRAM_BITS;
+        /** Offset of the z-index field. */
+        static constexpr unsigned int ZINDEX_SHIFT = OPAQUE_SHIFT + OPAQUE_BITS;
+        /** Offset of the reading mask field. */
+        static constexpr unsigned int READING_MASK_SHIFT = ZINDEX_SHIFT + ZINDEX_BITS;
+        /** Offset of the writing flag. */
+        static constexpr unsigned int WRITING_SHIFT = READING_MASK_SHIFT + READING_MASK_BITS;
+
+        /** Bits of the texture field. */
+        static constexpr uint64_t TEXTURE_FIELD = ((uint64_t{1} << TEXTURE_BITS) - 1) << TEXTURE_SHIFT;
+        /** Bits of the program field. */
+        static constexpr uint64_t PROGRAM_FIELD = ((uint64_t{1} << PROGRAM_BITS) - 1) << PROGRAM_SHIFT;
+        /** Bits of the opaque field. */
+        static constexpr uint64_t OPAQUE_FIELD = ((uint64_t{1} << OPAQUE_BITS) - 1) << OPAQUE_SHIFT;
+        /** Bits of the z-index field. */
+        static constexpr uint64_t ZINDEX_FIELD = ((uint64_t{1} << ZINDEX_BITS) - 1) << ZINDEX_SHIFT;
+        /** Bits of the reading mask field. */
+        static constexpr uint64_t READING_MASK_FIELD = ((uint64_t{1} << READING_MASK_BITS) - 1) << READING_MASK_SHIFT;
+        /** Bit of the writing flag. */
+        static constexpr uint64_t WRITING_FIELD = uint64_t{1} << WRITING_SHIFT;
+
+        static_assert(WRITING_SHIFT == 63, "BatchKey fields must fill exactly 64 bits");
+
+        /** Largest reading mask ID the key can hold. */
+        static constexpr uint32_t MAX_READING_MASK = (uint32_t{1} << READING_MASK_BITS) - 1;
+        /** Largest texture slot the key can hold. */
+        static constexpr uint32_t MAX_TEXTURE_SLOT = (uint32_t{1} << TEXTURE_BITS) - 1;
+
+        /**
+         * @brief Packed key value.
+         * 
+         * @note Use the accessors to read individual fields.
+         */
+        uint64_t value;
+
+        /**
+         * @brief Default constructor for BatchKey.
+         */
+        constexpr BatchKey() noexcept : value(0) {}
+
         /**
-         * @brief Writing mask.
+         * @brief Constructor for BatchKey.
          * 
-         * Indicates which buffers are written to during rendering.
+         * @param writing Whether the graphic writes to a mask.
+         * @param readingMask Mask ID read by the graphic, at most MAX_READING_MASK.
+         * @param zindex Z-index, lower values rendered first. Fractional values keep their order.
+         * @param isOpaque Whether the graphic is opaque.
+         * @param programID Shader program ID, truncated to PROGRAM_BITS.
+         * @param textureSlot Texture slot given by BatchKeySlots, at most MAX_TEXTURE_SLOT.
          * 
-         * @note Used for batching graphics with similar write operations.
+         * @note Out of range values are masked so they cannot spill into the other fields,
+         *       the callers check the ranges.
          */
-        int writingMask;
+        BatchKey(bool writing, uint32_t readingMask, float zindex, bool isOpaque, uint32_t programID, uint32_t textureSlot) noexcept
+            : value((static_cast<uint64_t>(writing) << WRITING_SHIFT) |
+                    ((static_cast<uint64_t>(readingMask) << READING_MASK_SHIFT) & READING_MASK_FIELD) |
+                    (static_cast<uint64_t>(EncodeZIndex(zindex)) << ZINDEX_SHIFT) |
+                    (static_cast<uint64_t>(isOpaque) << OPAQUE_SHIFT) |
+                    ((static_cast<uint64_t>(programID) << PROGRAM_SHIFT) & PROGRAM_FIELD) |
+                    ((static_cast<uint64_t>(textureSlot) << TEXTURE_SHIFT) & TEXTURE_FIELD)) {}
 
         /**
-         * @brief Reading mask.
+         * @brief Encode a float z-index into an order-preserving unsigned integer.
          * 
-         * Indicates which buffers are read from during rendering.
+         * @param zindex Z-index to encode.
+         * @return Encoded z-index.
          * 
-         * @note Used for batching graphics with similar read operations.
+         * @note Negative values have all bits flipped and positive values their sign bit set,
+         *       so unsigned comparison matches float comparison. -0 is encoded as +0.
          */
-        int readingMask;
+        static uint32_t EncodeZIndex(float zindex) noexcept {
+            zindex += 0.0f; // -0 + 0 == +0
+            uint32_t bits;
+            std::memcpy(&bits, &zindex, sizeof(bits));
+            return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        }
 
         /**
-         * @brief Z-index for rendering order.
+         * @brief Decode a z-index encoded by EncodeZIndex.
          * 
-         * Determines the rendering order of graphics, with lower values rendered first.
+         * @param encoded Encoded z-index.
+         * @return Decoded z-index.
+         */
+        static float DecodeZIndex(uint32_t encoded) noexcept {
+            uint32_t bits = (encoded & 0x80000000u) ? (encoded & 0x7FFFFFFFu) : ~encoded;
+            float zindex;
+            std::memcpy(&zindex, &bits, sizeof(zindex));
+            return zindex;
+        }
+
+        /**
+         * @brief Check if the key belongs to a mask writing graphic.
          * 
-         * @note Used for batching graphics with similar depth.
+         * @return true if the graphic writes to a mask, false otherwise.
          */
-        int zindex;
+        bool isWriting() const noexcept { return (value & WRITING_FIELD) != 0; }
 
         /**
-         * @brief Opaqueness flag.
+         * @brief Get the reading mask ID.
          * 
-         * Indicates whether the graphic is opaque or transparent.
+         * @return Reading mask ID.
+         */
+        uint32_t getReadingMask() const noexcept { return static_cast<uint32_t>((value & READING_MASK_FIELD) >> READING_MASK_SHIFT); }
+
+        /**
+         * @brief Get the z-index.
          * 
-         * @note Used for batching graphics with similar transparency.
+         * @return Z-index.
          */
-        bool isOpaque;
+        float getZIndex() const noexcept { return DecodeZIndex(static_cast<uint32_t>((value & ZINDEX_FIELD) >> ZINDEX_SHIFT)); }
 
         /**
-         * @brief Shader program ID.
+         * @brief Check if the key belongs to an opaque graphic.
          * 
-         * Identifier for the shader program used for rendering.
+         * @return true if the graphic is opaque, false otherwise.
+         */
+        bool isOpaque() const noexcept { return (value & OPAQUE_FIELD) != 0; }
+
+        /**
+         * @brief Get the shader program ID.
          * 
-         * @note Used for batching graphics using the same shader.
+         * @return Program ID.
          */
-        uint32_t programID;
+        uint32_t getProgramID() const noexcept { return static_cast<uint32_t>((value & PROGRAM_FIELD) >> PROGRAM_SHIFT); }
 
         /**
-         * @brief Texture ID.
+         * @brief Get the texture slot.
          * 
-         * Identifier for the texture used for rendering.
+         * @return Texture slot.
+         */
+        uint32_t getTextureSlot() const noexcept { return static_cast<uint32_t>((value & TEXTURE_FIELD) >> TEXTURE_SHIFT); }
+
+        /**
+         * @brief Check if two keys share the given fields.
          * 
-         * @note Used for batching graphics using the same texture.
+         * @param other The other BatchKey to compare with.
+         * @param fields Combination of the *_FIELD masks to compare.
+         * @return true if every selected bit is equal, false otherwise.
          */
-        uint32_t textureID;
+        bool matches(const BatchKey& other, uint64_t fields) const noexcept {
+            return ((value ^ other.value) & fields) == 0;
+        }
+
+        /**
+         * @brief Get the packed 64-bit sort key.
+         *
+         * @return Integer whose ordering matches operator<.
+         */
+        uint64_t getSortKey() const noexcept { return value; }
 
         /**
          * @brief Less-than operator for ordering.
@@ -115,8 +235,7 @@ namespace RaeptorCogs {
          * @note Used for sorting BatchKeys in collections.
          */
         bool operator<(const BatchKey& other) const noexcept {
-            return std::tie(writingMask, readingMask, zindex, isOpaque, programID, textureID)
-                < std::tie(other.writingMask, other.readingMask, other.zindex, other.isOpaque, other.programID, other.textureID);
+            return value < other.value;
         }
 
         /**
@@ -152,14 +271,73 @@ namespace RaeptorCogs {
          * @note Used for comparing BatchKeys in collections.
          */
         bool operator==(const BatchKey& other) const noexcept {
-            return writingMask == other.writingMask &&
-                readingMask == other.readingMask &&
-                zindex      == other.zindex &&
-                isOpaque    == other.isOpaque &&
-                programID   == other.programID &&
-                textureID   == other.textureID;
+            return value == other.value;
         }
     };
+
+    /**
+     * @brief Batch key slot table.
+     * 
+     * Maps IDs too wide for a BatchKey field, such as texture IDs, to dense slots that fit it.
+     * Two different IDs never share a slot, so keys comparing equal use the same texture.
+     * 
+     * @note Slots are never released. GL reuses the names of deleted textures, so the table
+     *       grows with the largest number of textures alive at once, not with their total.
+     */
+    class BatchKeySlots {
+        private:
+
+            // ============================================================================
+            //                               PRIVATE ATTRIBUTES
+            // ============================================================================
+
+            /**
+             * @brief Slot of each ID seen so far.
+             */
+            std::unordered_map<uint32_t, uint32_t> slots;
+
+            /**
+             * @brief Number of slots the field can hold.
+             */
+            size_t capacity;
+
+        public:
+
+            // ============================================================================
+            //                               PUBLIC METHODS
+            // ============================================================================
+
+            /**
+             * @brief Constructor for BatchKeySlots.
+             * 
+             * @param bits Number of bits of the field the slots go in.
+             */
+            explicit BatchKeySlots(unsigned int bits) : capacity(size_t{1} << bits) {}
+
+            /**
+             * @brief Get the slot of an ID, giving it the next free one on first use.
+             * 
+             * @param id ID to look up.
+             * @return Slot of the ID.
+             * 
+             * @throws std::runtime_error if every slot is taken.
+             */
+            uint32_t get(uint32_t id) {
+                auto [it, inserted] = this->slots.try_emplace(id, static_cast<uint32_t>(this->slots.size()));
+                if (inserted && this->slots.size() > this->capacity) {
+                    this->slots.erase(it);
+                    throw std::runtime_error("BatchKeySlots::get: no slot left for ID " + std::to_string(id));
+                }
+                return it->second;
+            }
+
+            /**
+             * @brief Get the number of slots in use.
+             * 
+             * @return Number of slots given so far.
+             */
+            size_t size() const { return this->slots.size(); }
+    };
 }
 
 
@@ -168,6 +346,8 @@ namespace RaeptorCogs::GAPI::Common {
      * @brief Graphic batch handler structure.
      * 
      * Manages batching information for a graphic during rendering.
+     * 
+     * @note The batch key of the handler is stored apart, see BatchBuffer::getKey.
      */
     struct GraphicBatchHandler {
         /**
@@ -197,13 +377,6 @@ namespace RaeptorCogs::GAPI::Common {
          */
         unsigned int dynamicDataSize;
 
-        /**
-         * @brief Renderer key.
-         * 
-         * Unique key for batching based on rendering parameters.
-         */
-        BatchKey rendererKey;
-
         /**
          * @brief Pointer to the associated graphic.
          * 
@@ -215,18 +388,19 @@ namespace RaeptorCogs::GAPI::Common {
          * @brief Dirty flag.
          * 
          * Indicates whether the graphic's data has changed and needs to be re-uploaded.
+         * 
+         * @note Set while the handler is queued in the render pipeline's dirty handlers.
          */
         bool isDirty;
 
         /**
          * @brief Constructor for GraphicBatchHandler.
          * 
-         * @param key The BatchKey for this handler.
          * @param graphic Pointer to the associated Graphic2D.
          * 
          * @note Initializes cursors and dirty flag.
          */
-        GraphicBatchHandler(const BatchKey& key, Graphic2D* graphic) : staticDataCursor(0), dynamicDataCursor(0), dynamicDataSize(0), rendererKey(key), graphic(graphic), isDirty(false) {}
+        GraphicBatchHandler(Graphic2D* graphic) : staticDataCursor(0), dynamicDataCursor(0), dynamicDataSize(0), graphic(graphic), isDirty(false) {}
     };
 }
 
@@ -242,12 +416,12 @@ namespace std {
      * @note Outputs the BatchKey in a human-readable format.
      */
     inline std::ostream& operator<<(std::ostream& os, const RaeptorCogs::BatchKey& key) {
-        os << "{ writeMask=" << key.writingMask
-        << ", readMaskID=" << key.readingMask
-        << ", z=" << key.zindex
-        << ", opaque=" << key.isOpaque
-        << ", program=" << key.programID
-        << ", texture=" << key.textureID
+        os << "{ writeMask=" << key.isWriting()
+        << ", readMaskID=" << key.getReadingMask()
+        << ", z=" << key.getZIndex()
+        << ", opaque=" << key.isOpaque()
+        << ", program=" << key.getProgramID()
+        << ", texture=" << key.getTextureSlot()
         << " }";
         return os;
     }
@@ -265,7 +439,6 @@ namespace std {
         os << "GraphicBatchHandler { staticDataCursor=" << handler.staticDataCursor
             << ", dynamicDataCursor=" << handler.dynamicDataCursor
             << ", dynamicDataSize=" << handler.dynamicDataSize
-            << ", rendererKey=" << handler.rendererKey
             << ", graphic=" << handler.graphic;
         os << " }";
         return os;
@@ -38,16 +38,82 @@
  ***********************************************************************************/
 
 #pragma once
+#include <RaeptorCogs/PagedBuffer.hpp>
 #include <RaeptorCogs/Region.hpp>
 #include <RaeptorCogs/GAPI/Common/Core/GraphicHandler.hpp>
+#include <RaeptorCogs/GAPI/Common/Core/PersistentRingBuffer.hpp>
 #include <RaeptorCogs/GAPI/Common/Resources/Buffer.hpp>
 #include <RaeptorCogs/GAPI/Common/Resources/Object.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
 #include <vector>
+#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
 
 namespace RaeptorCogs::GAPI::Common {
 
+// Packing helpers matching GLSL unpackUnorm2x16 / unpackUnorm4x8 (first component in the low bits)
+inline uint32_t PackUnorm16x2(float low, float high) {
+    auto quantize = [](float value) {
+        return static_cast<uint32_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    };
+    return quantize(low) | (quantize(high) << 16);
+}
+
+inline uint32_t PackUnorm8x4(float x, float y, float z, float w) {
+    auto quantize = [](float value) {
+        return static_cast<uint32_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    };
+    return quantize(x) | (quantize(y) << 8) | (quantize(z) << 16) | (quantize(w) << 24);
+}
+
+// Type in the low 8 bits, then 12 bits per mask ID
+static constexpr int COMPACT_MASK_ID_BITS = 12;
+static constexpr int COMPACT_MAX_MASK_ID = (1 << COMPACT_MASK_ID_BITS) - 1;
+
+// Throws std::runtime_error rather than wrapping a mask ID into another mask's
+inline uint32_t PackTypeAndMasks(int type, int readingMaskID, int writingMaskID) {
+    if (readingMaskID < 0 || readingMaskID > COMPACT_MAX_MASK_ID || writingMaskID < 0 || writingMaskID > COMPACT_MAX_MASK_ID) {
+        throw std::runtime_error("Mask IDs " + std::to_string(readingMaskID) + "/" + std::to_string(writingMaskID)
+            + " do not fit the compact instance layout, max " + std::to_string(COMPACT_MAX_MASK_ID));
+    }
+    return (static_cast<uint32_t>(type) & 0xFFu)
+        | ((static_cast<uint32_t>(readingMaskID) & COMPACT_MAX_MASK_ID) << 8)
+        | ((static_cast<uint32_t>(writingMaskID) & COMPACT_MAX_MASK_ID) << (8 + COMPACT_MASK_ID_BITS));
+}
+
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+// 2D layout: affine transform, quantized UVs and the color folded into the instance
+struct alignas(16) StaticInstanceData {
+    float linear[4];              // 16 bytes, 2x2 part of the model matrix, column major
+    float translation[2];         // 8 bytes
+    float z;                      // 4 bytes
+    uint32_t color;               // 4 bytes, RGBA8
+    uint32_t uvRect[2];           // 8 bytes, unorm16 x/y then w/h (no flipped rects)
+    uint32_t typeAndMasks;        // 4 bytes, see PackTypeAndMasks
+    unsigned int dataOffset;      // 4 bytes
+
+    void setModel(const glm::mat4& model) {
+        linear[0] = model[0][0]; linear[1] = model[0][1];
+        linear[2] = model[1][0]; linear[3] = model[1][1];
+        translation[0] = model[3][0]; translation[1] = model[3][1];
+        z = model[3][2];
+    }
+    void setUVRect(const glm::vec4& rect) {
+        uvRect[0] = PackUnorm16x2(rect.x, rect.y);
+        uvRect[1] = PackUnorm16x2(rect.z, rect.w);
+    }
+    void setColor(const glm::vec3& rgb) { color = PackUnorm8x4(rgb.x, rgb.y, rgb.z, 1.0f); }
+    void setTypeAndMasks(int type, int readingMaskID, int writingMaskID) {
+        typeAndMasks = PackTypeAndMasks(type, readingMaskID, writingMaskID);
+    }
+};
+static_assert(sizeof(StaticInstanceData) == 48, "Compact instance layout must match InstanceGPUData in main_common.vs");
+#else
 struct alignas(16) StaticInstanceData {
     glm::mat4 model;              // 64 bytes
     glm::vec4 uvRect;             // 16 bytes
@@ -55,10 +121,20 @@ struct alignas(16) StaticInstanceData {
     unsigned int dataOffset;               // 4 bytes
     int writingMaskID;              // 4 bytes
     int readingMaskID;               // 4 bytes
+
+    void setModel(const glm::mat4& matrix) { model = matrix; }
+    void setUVRect(const glm::vec4& rect) { uvRect = rect; }
+    void setTypeAndMasks(int instanceType, int reading, int writing) {
+        type = instanceType;
+        readingMaskID = reading;
+        writingMaskID = writing;
+    }
 };
+#endif
 using DynamicInstanceData = float;
-using StaticInstanceDataBuffer = std::vector<StaticInstanceData>;
-using DynamicInstanceDataBuffer = std::vector<float>;
+// Paged so that growing never copies the data nor invalidates references
+using StaticInstanceDataBuffer = PagedBuffer<StaticInstanceData>;
+using DynamicInstanceDataBuffer = PagedBuffer<float>;
 
 
 struct InstanceData {
@@ -68,6 +144,8 @@ struct InstanceData {
     public:
         StaticInstanceDataBuffer& getStatic() { return staticData; }
         DynamicInstanceDataBuffer& getDynamic() { return dynamicData; }
+        const StaticInstanceDataBuffer& getStatic() const { return staticData; }
+        const DynamicInstanceDataBuffer& getDynamic() const { return dynamicData; }
 };
 
 
@@ -92,18 +170,60 @@ class InstanceAllocator {
         StaticInstanceData& getStaticInstanceData(size_t offset);
         DynamicInstanceData* getDynamicInstanceData(size_t offset);
 
+        // Defragmentation: move a graphic's data into a free region when that one is further
+        // front, updating its cursors; returns false when nothing moved
+        bool moveStaticDataFront(GraphicBatchHandler& batchHandler);
+        bool moveDynamicDataFront(GraphicBatchHandler& batchHandler);
+        // Drops the free regions ending the arrays and releases their pages
+        void trim();
+        bool hasFreeStaticData() const { return !freeStaticDataRegionsAllocator.empty(); }
+        bool hasFreeDynamicData() const { return !freeDynamicDataRegionsAllocator.empty(); }
+        size_t getStaticDataSize() const { return instanceData.getStatic().size(); }
+
+};
+
+enum class InstanceUploadMode {
+    BUFFER_SUB_DATA,        // glBufferSubData into the instance SSBOs
+    PERSISTENT_RING         // Copies into persistently mapped, triple-buffered slices (GL 4.4, not on Emscripten)
 };
 
 class InstanceUploader {
     private:
         InstanceData& instanceData;
-        RegionBuffer dirtyStaticDataRegions;
-        RegionBuffer dirtyDynamicDataRegions;
+        // Unsorted until upload, coalesced there in one pass
+        std::vector<Region> dirtyStaticDataRegions;
+        std::vector<Region> dirtyDynamicDataRegions;
+        InstanceUploadMode mode = InstanceUploadMode::BUFFER_SUB_DATA;
+        // The instance SSBOs get their storage on the first upload
+        bool bindingsOutdated = true;
+        #ifndef __EMSCRIPTEN__
+        // Elements the instance SSBOs hold in BUFFER_SUB_DATA mode
+        size_t staticBufferCapacity = 0;
+        size_t dynamicBufferCapacity = 0;
+        PersistentRingBuffer staticDataRing;
+        PersistentRingBuffer dynamicDataRing;
+
+        // Reallocates the SSBO when its capacity no longer fits the size, keeping the data on the GPU.
+        // Returns true if the buffer was replaced and must be bound again.
+        bool fitBuffer(RaeptorCogs::GAPI::ObjectHandler<SSBO>* ssbo, size_t& capacity, size_t size, size_t elementSize);
+        #endif
     public:
+        // Bytes costing as much to send as one extra buffer update call; smaller gaps are uploaded through
+        static constexpr size_t UPLOAD_CALL_COST = 16384;
+        // Smallest capacity of the instance SSBOs, in elements
+        static constexpr size_t MIN_BUFFER_CAPACITY = 4096;
+
+        // Capacity fitting size: doubles while too small, halves while under a quarter used
+        static size_t GetBufferCapacity(size_t capacity, size_t size);
+
         InstanceUploader(InstanceData& instanceData) : instanceData(instanceData) {}
         void markStaticDataDirty(size_t offset, size_t size);
         void markDynamicDataDirty(size_t offset, size_t size);
-        void upload(RaeptorCogs::GAPI::ObjectHandler<SSBO>* staticInstanceDataSSBO, RaeptorCogs::GAPI::ObjectHandler<SSBO>* dynamicInstanceDataSSBO);
+        UploadStats upload(RaeptorCogs::GAPI::ObjectHandler<SSBO>* staticInstanceDataSSBO, RaeptorCogs::GAPI::ObjectHandler<SSBO>* dynamicInstanceDataSSBO);
+
+        // Throws std::runtime_error if the mode is not supported by the context
+        void setUploadMode(InstanceUploadMode mode);
+        InstanceUploadMode getUploadMode() const { return mode; }
 };
 
 }
\ No newline at end of file
@@ -131,6 +131,13 @@ class GraphicCore {
          */
         InstanceUploader instanceUploader{instanceData};
 
+        /**
+         * @brief Upload statistics of the current frame.
+         * 
+         * Counts the buffer updates issued by updateGraphicGPUData since the last reset.
+         */
+        UploadStats uploadStats;
+
     protected:
 
         // ============================================================================
@@ -169,10 +176,25 @@ class GraphicCore {
         /**
          * @brief Update the GPU data for graphics.
          * 
-         * @note Uploads instance data and order indices to the GPU.
+         * @note Uploads instance data and order indices to the GPU, coalescing the regions
+         *       changed since the last call into as few buffer updates as possible.
          */
         void updateGraphicGPUData();
 
+        /**
+         * @brief Get the upload statistics of the current frame.
+         * 
+         * @return Number of buffer updates and bytes uploaded since the last reset.
+         */
+        const UploadStats& getUploadStats() const { return this->uploadStats; }
+
+        /**
+         * @brief Reset the upload statistics.
+         * 
+         * @note Called at the start of each frame.
+         */
+        void resetUploadStats() { this->uploadStats = UploadStats(); }
+
         /**
          * @brief Get the instance data.
          * 
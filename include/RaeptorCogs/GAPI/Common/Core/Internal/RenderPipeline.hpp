@@ -49,6 +49,7 @@
 namespace RaeptorCogs {
     class Component;
     class Window;
+    enum class ComputeInstanceDataMode;
 
     void MainLoop(std::function<void(Window&)> updateFunction, Window &window);
 }
@@ -62,6 +63,13 @@ namespace RaeptorCogs::GAPI::Common {
  */
 using ComponentBuffer = std::vector<Component*>;
 
+/**
+ * @brief Dirty handler buffer type.
+ * 
+ * Holds the batch indices of the handlers whose instance data changed this frame.
+ */
+using DirtyHandlerBuffer = std::vector<size_t>;
+
 /**
  * @brief Private render list identifiers.
  * 
@@ -127,6 +135,34 @@ class RenderPipeline {
          */
         int currentBatchIndex = 0;
 
+        /**
+         * @brief Dirty handler buffer.
+         * 
+         * Holds the handlers flagged by Graphic2D::setDataDirty since the last update.
+         */
+        DirtyHandlerBuffer dirtyHandlers;
+
+        /**
+         * @brief Next handler visited by the dynamic data defragmentation.
+         * 
+         * @note Sweeps the batch buffer round-robin, a budget's worth per frame.
+         */
+        size_t defragmentCursor = 0;
+
+        /**
+         * @brief Texture slot bound by the last draw call of the batch.
+         * 
+         * @note Lets consecutive draw commands on the same texture skip the rebind.
+         */
+        uint32_t boundTextureSlot = UINT32_MAX;
+
+        /**
+         * @brief Slots of the textures used in batch keys.
+         * 
+         * @note Texture IDs do not fit the key, see BatchKeySlots.
+         */
+        BatchKeySlots textureSlots{BatchKey::TEXTURE_BITS};
+
         // ============================================================================
         //                             PRIVATE METHODS
         // ============================================================================
@@ -145,6 +181,41 @@ class RenderPipeline {
          */
         virtual void endFrame() = 0;
 
+        /**
+         * @brief Recompute the instance data of a handler.
+         * 
+         * @param index Index of the handler in the batch buffer.
+         * @param mode Mode passed to Graphic2D::computeInstanceData.
+         * 
+         * @note Marks the handler's instance data for upload if it changed.
+         */
+        void updateHandler(size_t index, ComputeInstanceDataMode mode);
+
+        /**
+         * @brief Recompute the instance data of the dirty handlers.
+         * 
+         * @note Only visits the handlers flagged since the last update, so a static
+         *       scene costs nothing here regardless of its size.
+         */
+        void updateDirtyHandlers();
+
+        /**
+         * @brief Move a live handler to a free index of the batch buffer.
+         * 
+         * @param from Current index of the handler.
+         * @param to Free index receiving it.
+         * 
+         * @note Updates the graphic's cursor, the render lists holding it and the dirty handlers.
+         */
+        void relocateHandler(size_t from, size_t to);
+
+        /**
+         * @brief Rebuild the instance data of draw commands whose texture atlas was repacked.
+         * 
+         * @param renderList Render list the draw commands were built from.
+         */
+        void rebuildTextureCommands(RenderList& renderList);
+
         friend void RaeptorCogs::MainLoop(const std::function<void(Window&)> updateFunction, Window &window);
 
     protected:
@@ -185,6 +256,15 @@ class RenderPipeline {
 
     public:
 
+        // ============================================================================
+        //                               PUBLIC CONSTANTS
+        // ============================================================================
+
+        /**
+         * @brief Bytes of instance data the defragmentation may move per frame.
+         */
+        static constexpr size_t DEFRAGMENT_BYTE_BUDGET = 256 * 1024;
+
         // ============================================================================
         //                               PUBLIC METHODS
         // ============================================================================
@@ -204,13 +284,13 @@ class RenderPipeline {
         /**
          * @brief Check if two batches are compatible for merging.
          * 
-         * @param a Pointer to the first GraphicBatchHandler.
-         * @param b Pointer to the second GraphicBatchHandler.
+         * @param a Batch key of the first GraphicBatchHandler.
+         * @param b Batch key of the second GraphicBatchHandler.
          * @return True if the batches are compatible, false otherwise.
          * 
          * @note Batches are compatible if they share the same rendering parameters.
          */
-        bool compatibleBatches(GraphicBatchHandler* a, GraphicBatchHandler* b);
+        bool compatibleBatches(const BatchKey& a, const BatchKey& b);
 
         /**
          * @brief Begin a new batch for rendering.
@@ -235,21 +315,20 @@ class RenderPipeline {
          *    // Custom operations after drawing
          * });
          * @endcode
-         * @note Uploads instance data and issues draw calls for the batch.
+         * @note Uploads instance data and issues draw calls for the batch. The draw
+         *       commands are only rebuilt when the render list order or a batch key changed.
          */
         void processBatch(std::function<void()> postDrawCallback = nullptr);
 
         /**
          * @brief Draw a batch of instances.
          * 
-         * @param firstHandler Pointer to the first GraphicBatchHandler in the batch.
-         * @param instanceOffset Offset of the first instance to draw.
-         * @param instanceCount Number of instances to draw.
+         * @param command Draw command describing the instances to draw.
          * @param postDrawCallback Optional callback to be executed after drawing.
          * 
          * @note Issues the draw call for the specified batch of instances.
          */
-        void drawBatch(GraphicBatchHandler* firstHandler, size_t instanceOffset, size_t instanceCount, std::function<void()> postDrawCallback = nullptr);
+        void drawBatch(const DrawCommand& command, std::function<void()> postDrawCallback = nullptr);
         
         /**
          * @brief Flush the current batch.
@@ -285,6 +364,37 @@ class RenderPipeline {
          */
         void clearRenderLists();
 
+        /**
+         * @brief Compact the render lists.
+         * 
+         * @note Drops the tombstones left by graphics removed since the last compaction,
+         *       in a single pass per render list. Called at the start of each frame.
+         */
+        void compactRenderLists();
+
+        /**
+         * @brief Move live instance data toward the front of the instance buffers.
+         * 
+         * @param byteBudget Bytes of instance data that may be moved, or visited, this call.
+         * 
+         * @note Moves the last live static instance into a hole, handler included,
+         *       then sweeps the handlers for dynamic data that fits a lower free region.
+         *       Freed tails are trimmed so the buffers shrink: the next upload reallocates
+         *       the instance SSBOs once under a quarter used. Called at the start of each
+         *       frame; picks up where it stopped when the budget runs out.
+         */
+        void defragmentInstances(size_t byteBudget = DEFRAGMENT_BYTE_BUDGET);
+
+        /**
+         * @brief Mark a handler's instance data as dirty.
+         * 
+         * @param index Index of the handler in the batch buffer.
+         * 
+         * @note Called by Graphic2D::setDataDirty. The handler is recomputed once
+         *       at the next processBatch, however many times it is marked.
+         */
+        void markHandlerDirty(size_t index);
+
         /**
          * @brief Get the component buffer.
          * 
@@ -302,6 +412,26 @@ class RenderPipeline {
          */
         GraphicBatchHandler &getBatchHandlerAt(size_t index);
 
+        /**
+         * @brief Get the batch key of the handler at the specified index.
+         * 
+         * @param index Index of the batch handler.
+         * @return Reference to the BatchKey.
+         * 
+         * @note Render lists must be told when it changes, see RenderList::markDirty.
+         */
+        BatchKey &getBatchKeyAt(size_t index);
+
+        /**
+         * @brief Get the batch key slot of a texture.
+         * 
+         * @param textureID Texture ID.
+         * @return Slot to build the batch key with.
+         * 
+         * @throws std::runtime_error if more textures are in use than the key can tell apart.
+         */
+        uint32_t getTextureSlot(uint32_t textureID);
+
         /**
          * @brief Get the frame data.
          * 
@@ -0,0 +1,250 @@
+/** ********************************************************************************
+ * @section GAPI_Common_Core_PersistentRingBuffer_Overview Overview
+ * @file PersistentRingBuffer.hpp
+ * @brief Persistently mapped, triple-buffered GPU storage.
+ * @details
+ * Typical use cases:
+ * - Streaming instance data to the GPU without driver copies or CPU/GPU serialization
+ * *********************************************************************************
+ * @section GAPI_Common_Core_PersistentRingBuffer_Header Header
+ * <RaeptorCogs/GAPI/Common/Core/PersistentRingBuffer.hpp>
+ ***********************************************************************************
+ * @section GAPI_Common_Core_PersistentRingBuffer_Metadata Metadata
+ * @author Estorc
+ * @version v1.0
+ * @copyright Copyright (c) 2025 Estorc MIT License.
+ **********************************************************************************/
+/*                             This file is part of
+ *                                  RaeptorCogs
+ *                     (https://github.com/Estorc/RaeptorCogs)
+ ***********************************************************************************
+ * Copyright (c) 2025 Estorc.
+ * This file is licensed under the MIT License.
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ***********************************************************************************/
+
+
+#pragma once
+#include <RaeptorCogs/Region.hpp>
+#include <RaeptorCogs/GAPI/Common/Resources/Buffer.hpp>
+#include <RaeptorCogs/GAPI/Common/Resources/Object.hpp>
+#include <array>
+#include <functional>
+#include <vector>
+
+/** @brief GL fence object, declared by glad. */
+struct __GLsync;
+
+namespace RaeptorCogs::GAPI::Common {
+
+/**
+ * @brief Upload statistics structure.
+ * 
+ * Counts the buffer updates issued and the bytes they sent.
+ */
+struct UploadStats {
+    /** Buffer update calls, or copies into mapped memory */
+    size_t uploadCount = 0;
+    /** Bytes sent by those updates */
+    size_t uploadedBytes = 0;
+
+    /**
+     * @brief Accumulate another set of statistics.
+     * 
+     * @param other Statistics to add.
+     * @return Reference to these statistics.
+     */
+    UploadStats& operator+=(const UploadStats& other) {
+        this->uploadCount += other.uploadCount;
+        this->uploadedBytes += other.uploadedBytes;
+        return *this;
+    }
+};
+
+/**
+ * @brief Persistent ring buffer class.
+ * 
+ * Holds SLICE_COUNT copies of a buffer in one persistently and coherently mapped
+ * storage. A write following draws that read the current slice fences it and moves
+ * to the next one, so the CPU never writes memory the GPU may still be reading,
+ * however many passes or frames the writes are spread over.
+ * 
+ * @code{.cpp}
+ * ring.write(changedRegions, data.size() * sizeof(float), [&](size_t begin, size_t end, unsigned char* destination) {
+ *     std::memcpy(destination, reinterpret_cast<const unsigned char*>(data.data()) + begin, end - begin);
+ * });
+ * ring.bind(2);                                       // Bind the slice to binding 2
+ * // ... draw ...
+ * @endcode
+ * 
+ * @note Requires glBufferStorage (GL 4.4), unavailable on Emscripten.
+ */
+class PersistentRingBuffer {
+    public:
+
+        /**
+         * @brief Copies source bytes [begin, end) into mapped memory.
+         */
+        using SourceCopy = std::function<void(size_t begin, size_t end, unsigned char* destination)>;
+
+        // ============================================================================
+        //                               PUBLIC CONSTANTS
+        // ============================================================================
+
+        /**
+         * @brief Number of slices in the ring.
+         * 
+         * @note One being written by the CPU, up to two still read by the GPU.
+         *       Writes with nothing new keep the slice, so a frame usually takes one.
+         */
+        static constexpr size_t SLICE_COUNT = 3;
+
+        /**
+         * @brief Smallest slice size allocated, in bytes.
+         */
+        static constexpr size_t MIN_SLICE_SIZE = 1 << 16;
+
+    private:
+
+        // ============================================================================
+        //                             PRIVATE MEMBERS
+        // ============================================================================
+
+        /**
+         * @brief Storage holding every slice.
+         * 
+         * @note Immutable storage, replaced when the ring grows.
+         */
+        RaeptorCogs::GAPI::ObjectHandler<SSBO> storage;
+
+        /**
+         * @brief Persistent mapping of the storage.
+         */
+        unsigned char* mapped = nullptr;
+
+        /**
+         * @brief Size of one slice in bytes.
+         * 
+         * @note Rounded up to the shader storage offset alignment.
+         */
+        size_t sliceSize = 0;
+
+        /**
+         * @brief Number of bytes of the source in use.
+         */
+        size_t usedSize = 0;
+
+        /**
+         * @brief Slice written and bound.
+         */
+        size_t currentSlice = 0;
+
+        /**
+         * @brief Whether draws may read the current slice.
+         * 
+         * @note Set on bind; the next write with changes moves to another slice.
+         */
+        bool sliceBound = false;
+
+        /**
+         * @brief Fences signaled when the GPU is done with each slice.
+         */
+        std::array<__GLsync*, SLICE_COUNT> fences{};
+
+        /**
+         * @brief Byte regions still to be copied into each slice.
+         * 
+         * @note A change reaches every slice, one write after the other.
+         */
+        std::array<std::vector<Region>, SLICE_COUNT> pendingRegions;
+
+        // ============================================================================
+        //                             PRIVATE METHODS
+        // ============================================================================
+
+        /**
+         * @brief Resize the storage to hold a source of the given size.
+         * 
+         * @param size Source size in bytes.
+         * 
+         * @note Grows geometrically and shrinks when the source falls under a quarter
+         *       of a slice; every slice is then rewritten in full.
+         */
+        void reserve(size_t size);
+
+        /**
+         * @brief Fence the current slice and move to the next one.
+         * 
+         * @note Blocks until the GPU is done with the next slice, which only happens
+         *       when the CPU runs SLICE_COUNT slices ahead.
+         */
+        void nextSlice();
+
+    public:
+
+        // ============================================================================
+        //                               PUBLIC METHODS
+        // ============================================================================
+
+        /**
+         * @brief Default constructor.
+         */
+        PersistentRingBuffer() = default;
+
+        /**
+         * @brief Destructor.
+         * 
+         * @note Releases the fences; the storage is released by its handler.
+         */
+        ~PersistentRingBuffer();
+
+        PersistentRingBuffer(const PersistentRingBuffer&) = delete;
+        PersistentRingBuffer& operator=(const PersistentRingBuffer&) = delete;
+
+        /**
+         * @brief Copy changed regions of the source into the current slice.
+         * 
+         * @param regions Changed byte regions of the source, sorted and merged.
+         * @param size Size of the source in bytes.
+         * @param copy Copies the source bytes [begin, end) to the destination.
+         * @return Copies made and bytes copied into the slice.
+         * 
+         * @note Moves to the next slice first if the current one was bound since its last
+         *       write, then also copies the regions that slice has not seen yet. Does
+         *       nothing when the current slice is up to date. The source does not need
+         *       to be contiguous.
+         */
+        UploadStats write(const std::vector<Region>& regions, size_t size, const SourceCopy& copy);
+
+        /**
+         * @brief Bind the current slice to a shader storage binding.
+         * 
+         * @param binding Binding index in the shaders.
+         * 
+         * @note The slice is then considered read by the GPU until the next write moves on.
+         */
+        void bind(unsigned int binding);
+
+        /**
+         * @brief Check whether the ring holds storage.
+         * 
+         * @return True once something has been written.
+         */
+        bool isAllocated() const { return this->mapped != nullptr; }
+};
+
+} // namespace RaeptorCogs::GAPI::Common
@@ -39,14 +39,19 @@
 
 #pragma once
 #include <RaeptorCogs/Flags.hpp>
+#include <RaeptorCogs/Region.hpp>
+#include <RaeptorCogs/GAPI/Common/Core/BatchBuffer.hpp>
 #include <RaeptorCogs/GAPI/Common/Core/GraphicHandler.hpp>
 #include <RaeptorCogs/GAPI/Common/Core/InstanceData.hpp>
 #include <RaeptorCogs/GAPI/Common/Resources/Buffer.hpp>
 #include <RaeptorCogs/GAPI/Common/Resources/Object.hpp>
+#include <RaeptorCogs/Sort.hpp>
+#include <climits>
 #include <vector>
+#include <functional>
 #include <unordered_map>
 #include <algorithm>
-#include <execution>
+#include <climits>
 
 namespace RaeptorCogs::GAPI::Common {
 
@@ -60,22 +65,78 @@ namespace RaeptorCogs::GAPI::Common {
 using OrderIndicesBuffer = std::vector<unsigned int>;
 
 /**
- * @brief Graphic batch handler structure.
+ * @brief Order positions buffer.
  * 
- * Holds information about a graphic batch for rendering.
+ * Maps a batch index to its slot in the order indices buffer.
  * 
- * @note Used for batching graphics with similar rendering parameters.
+ * @note Used for constant time lookup of a handler in a render list.
  */
-using BatchBuffer = std::vector<GAPI::Common::GraphicBatchHandler>;
+using OrderPositionsBuffer = std::vector<unsigned int>;
 
 /**
- * @brief Dirty handlers buffer.
+ * @brief Dirty indices buffer.
  * 
- * Holds references to graphic batch handlers that need re-ordering.
+ * Holds the batch indices of graphic batch handlers that need re-ordering.
  * 
  * @note Used for tracking graphics that have changed and need to be re-ordered.
+ *       Indices stay valid when the batch buffer reallocates.
  */
-using DirtyHandlersBuffer = std::vector<std::reference_wrapper<GraphicBatchHandler>>;
+using DirtyIndicesBuffer = std::vector<unsigned int>;
+
+/**
+ * @brief Draw command structure.
+ * 
+ * Describes a run of compatible instances drawn with a single call.
+ */
+struct DrawCommand {
+    /** Batch index of the first handler, used to bind the texture */
+    unsigned int handlerIndex;
+    /** Texture slot shared by the run, see BatchKeySlots */
+    uint32_t textureSlot;
+    /** Whether the run writes a mask */
+    bool writing;
+    /** Slot of the first instance in the render list */
+    unsigned int baseInstance;
+    /** Number of instances in the run */
+    unsigned int instanceCount;
+};
+
+/**
+ * @brief Draw command buffer.
+ * 
+ * Holds the draw commands of a render list, in drawing order.
+ */
+using DrawCommandBuffer = std::vector<DrawCommand>;
+
+/**
+ * @brief Render bucket structure.
+ * 
+ * Describes the contiguous slots of a bucketed render list holding one bucket key.
+ * 
+ * @note Buckets of a z layer follow each other, ordered by program and texture.
+ */
+struct RenderBucket {
+    /** Bucket key shared by the handlers, see RenderList::GetBucketKey */
+    uint64_t key;
+    /** First slot of the bucket */
+    size_t begin;
+    /** One past the last slot of the bucket */
+    size_t end;
+};
+
+/**
+ * @brief Render bucket buffer.
+ * 
+ * Holds the buckets of a render list, in drawing order.
+ */
+using RenderBucketBuffer = std::vector<RenderBucket>;
+
+/**
+ * @brief Batch compatibility predicate.
+ * 
+ * Tells, from their batch keys, whether two adjacent handlers can be drawn with the same call.
+ */
+using BatchCompatibility = std::function<bool(const BatchKey&, const BatchKey&)>;
 
 /**
  * @brief Render list flags enumeration.
@@ -89,10 +150,12 @@ enum class RenderListFlags : uint32_t {
     NONE = 0,
     /** Needs reordering. */
     NEEDS_REORDER = 1 << 0,
-    /** Has been reordered. */
+    /** Order indices changed and must be uploaded. */
     REORDERED = 1 << 1,
-    /** SSBO created. */
-    SSBO_CREATED = 1 << 2
+    /** Holds tombstones left by erased handlers. */
+    NEEDS_COMPACTION = 1 << 3,
+    /** Order or batch keys changed since the draw commands were built. */
+    DRAW_COMMANDS_OUTDATED = 1 << 4
 };
 
 }
@@ -111,6 +174,7 @@ namespace RaeptorCogs::GAPI::Common {
  * Provides an iterator to traverse graphic batch handlers in a render list indirectly.
  * 
  * @note Used for iterating over graphics in a render list based on order indices.
+ *       Skips the slots erased since the last compaction.
  */
 class IndirectIterator {
     private:
@@ -139,6 +203,19 @@ class IndirectIterator {
          * Indicates the current position in the iteration.
          */
         size_t index_;
+
+        // ============================================================================
+        //                             PRIVATE METHODS
+        // ============================================================================
+
+        /**
+         * @brief Move forward to the next slot holding a handler.
+         * 
+         * @note Erased slots hold RenderList::TOMBSTONE.
+         */
+        void skipTombstones() {
+            while (index_ < order_.size() && order_[index_] == UINT_MAX) ++index_;
+        }
         
     public:
         /** Iterator category for indirect traversal of graphic batch handlers */
@@ -160,7 +237,7 @@ class IndirectIterator {
          * @param index Initial index for the iterator.
          */
         IndirectIterator(BatchBuffer& batch, const OrderIndicesBuffer& order, size_t index)
-            : batch_(batch), order_(order), index_(index) {}
+            : batch_(batch), order_(order), index_(index) { this->skipTombstones(); }
 
         /**
          * @brief Ordered item structure.
@@ -196,7 +273,7 @@ class IndirectIterator {
          * 
          * @return Reference to the incremented iterator.
          */
-        IndirectIterator& operator++() { ++index_; return *this; }
+        IndirectIterator& operator++() { ++index_; this->skipTombstones(); return *this; }
 
         /**
          * @brief Post-increment operator for IndirectIterator.
@@ -259,11 +336,60 @@ class RenderList {
         OrderIndicesBuffer orderIndices;
 
         /**
-         * @brief Dirty handlers buffer.
+         * @brief Order positions buffer.
          * 
-         * Holds references to graphic batch handlers that need re-ordering.
+         * Holds the slot of each batch index in the order indices buffer.
+         * 
+         * @note NO_POSITION for batch indices not in this render list.
+         */
+        OrderPositionsBuffer orderPositions;
+
+        /**
+         * @brief Number of tombstones in the order indices buffer.
+         */
+        size_t tombstoneCount = 0;
+
+        /**
+         * @brief Lowest slot holding a tombstone.
+         * 
+         * @note Compaction starts there.
+         */
+        size_t firstTombstone = SIZE_MAX;
+
+        /**
+         * @brief Slots of the order indices changed since the last upload.
+         */
+        DirtyRegions uploadRegions;
+
+        /**
+         * @brief Dirty indices buffer.
+         * 
+         * Holds the batch indices of graphic batch handlers that need re-ordering.
+         */
+        DirtyIndicesBuffer dirtyIndices;
+
+        /**
+         * @brief Dirty marks.
+         * 
+         * Flags, per batch index, the handlers in the dirty indices buffer.
+         * 
+         * @note Used to deduplicate dirty handlers and to skip them while reordering.
+         */
+        std::vector<uint8_t> dirtyMarks;
+
+        /**
+         * @brief Scratch buffer for the handlers extracted by a merge reorder.
+         */
+        OrderIndicesBuffer mergeScratch;
+
+        /**
+         * @brief Draw command buffer.
+         * 
+         * Holds the draw commands built by the last buildDrawCommands.
+         * 
+         * @note Replayed as is until the order or a batch key changes.
          */
-        DirtyHandlersBuffer dirtyHandlers;
+        DrawCommandBuffer drawCommands;
 
         /**
          * @brief Render list flags.
@@ -279,6 +405,37 @@ class RenderList {
          */
         RaeptorCogs::GAPI::ObjectHandler<Common::SSBO> indexIndirectionSSBO;
 
+        /**
+         * @brief Number of order indices the index indirection SSBO can hold.
+         * 
+         * @note 0 until the SSBO storage is first allocated.
+         */
+        size_t indirectionCapacity = 0;
+
+        /**
+         * @brief Radix sorter used for full reorders.
+         * 
+         * Keeps its scratch buffers between reorders.
+         */
+        RadixSorter radixSorter;
+
+        /**
+         * @brief Buckets of the render list.
+         * 
+         * @note Empty unless the render list is bucketed.
+         */
+        RenderBucketBuffer buckets;
+
+        /**
+         * @brief Width of the z ranges sharing a bucket, 0 for one bucket per z value.
+         */
+        float bucketRange = 0.0f;
+
+        /**
+         * @brief Whether the render list is bucketed.
+         */
+        bool bucketed = false;
+
         // ============================================================================
         //                             PRIVATE METHODS
         // ============================================================================
@@ -286,25 +443,234 @@ class RenderList {
         /**
          * @brief Do a binary search reorder of the render list.
          * 
-         * @param handler Reference to the GraphicBatchHandler that triggered the reorder.
+         * @param index Batch index of the handler that triggered the reorder.
+         * 
+         * @note Finds the current slot through the order positions and the new one with a binary
+         *       search skipping handlers still marked dirty, then shifts only the slots in between.
+         */
+        void binarySearchReorder(unsigned int index);
+
+        /**
+         * @brief Do a local reorder of the render list.
+         * 
+         * @param budget Maximum number of slots probed before giving up.
+         * @return True if every dirty handler was placed, false if the budget ran out.
+         * 
+         * @note Walks each dirty handler from its slot to its new one, skipping handlers still
+         *       marked dirty, in O(k + d) for k handlers moved by d slots in total. Handlers left
+         *       over when the budget runs out stay marked dirty.
+         */
+        bool localReorder(size_t budget);
+
+        /**
+         * @brief Estimate how far the dirty handlers moved.
+         * 
+         * @return Mean number of slots between the current and sorted slot of a sample of
+         *         the dirty handlers.
+         * 
+         * @note Binary searches at most DISPLACEMENT_SAMPLES handlers.
+         */
+        double estimateDisplacement() const;
+
+        /**
+         * @brief Move the handler of a slot to another slot.
+         * 
+         * @param position Current slot of the handler.
+         * @param target New slot of the handler.
+         * 
+         * @note Shifts the slots in between and marks them for upload.
+         */
+        void moveSlot(size_t position, size_t target);
+
+        /**
+         * @brief Merge reorder of the render list.
          * 
-         * @note Uses binary search to find the correct position for the handler.
+         * @note Extracts the dirty handlers, sorts them and merges them back into the still
+         *       sorted remainder in O(n + k log k).
          */
-        void binarySearchReorder(const GraphicBatchHandler& handler);
+        void mergeReorder();
 
         /**
          * @brief Radix reorder of the render list.
          * 
-         * @note Uses radix sort algorithm for reordering.
+         * @note Sorts the order indices on BatchKey::getSortKey.
          */
         void radixReorder();
 
+        /**
+         * @brief Comparison sort reorder of the render list.
+         * 
+         * @note Used for full reorders of lists below RADIX_SORT_THRESHOLD.
+         */
+        void comparisonReorder();
+
+        /**
+         * @brief Bucket reorder of the render list.
+         * 
+         * @note Moves each dirty handler to the bucket of its new key, in O(b) for a move
+         *       across b buckets. Falls back to sortBuckets when that costs more than a sort.
+         */
+        void bucketReorder();
+
+        /**
+         * @brief Sort the render list on the bucket keys and rebuild the buckets.
+         * 
+         * @note Also used to leave the bucketed mode, the bucket key then being the sort key.
+         */
+        void sortBuckets();
+
+        /**
+         * @brief Find the bucket holding a slot.
+         * 
+         * @param slot Slot in the order indices.
+         * @return Index of the bucket in the bucket buffer.
+         */
+        size_t findBucket(size_t slot) const;
+
+        /**
+         * @brief Move a handler to the bucket of its key.
+         * 
+         * @param index Batch index of the handler.
+         * @param source Bucket holding the handler, or the bucket count for a handler just
+         *               appended after the last bucket.
+         * 
+         * @note Opens the bucket if needed and drops the source bucket once empty.
+         */
+        void moveToBucket(unsigned int index, size_t source);
+
+        /**
+         * @brief Hand the slot of a handler over from one bucket to another.
+         * 
+         * @param position Slot of the handler.
+         * @param source Bucket holding the handler, or the bucket count past the last bucket.
+         * @param target Bucket receiving the handler, or the bucket count past the last bucket.
+         * @return New slot of the handler.
+         * 
+         * @note Swaps the handler with the edge slot of each bucket in between, which keeps
+         *       every bucket contiguous.
+         */
+        size_t handOverSlot(size_t position, size_t source, size_t target);
+
+        /**
+         * @brief Swap the handlers of two slots.
+         * 
+         * @param first First slot.
+         * @param second Second slot.
+         * 
+         * @note Updates their order positions and marks both slots for upload.
+         */
+        void swapSlots(size_t first, size_t second);
+
+        /**
+         * @brief Update the order positions of a range of slots.
+         * 
+         * @param first First slot to update.
+         * @param last One past the last slot to update.
+         */
+        void updatePositions(size_t first, size_t last);
+
+        /**
+         * @brief Mark a range of slots for upload.
+         * 
+         * @param first First changed slot.
+         * @param last One past the last changed slot.
+         */
+        void markUploadRange(size_t first, size_t last);
+
+        /**
+         * @brief Resize the index indirection SSBO for the current list size.
+         * 
+         * @return True if the SSBO was reallocated and must be bound again.
+         * 
+         * @note The slots still valid on the GPU are copied with glCopyBufferSubData, unless
+         *       the pending upload covers all of them.
+         */
+        bool fitIndirection();
+
     public:
 
         // ============================================================================
         //                             PUBLIC METHODS
         // ============================================================================
 
+        /**
+         * @brief Minimum list size for which full reorders use the radix sort.
+         * 
+         * @note Below this size std::sort is faster than the radix histogram passes.
+         */
+        static constexpr size_t RADIX_SORT_THRESHOLD = 512;
+
+        /**
+         * @brief Maximum number of dirty handlers moved one by one during a reorder.
+         * 
+         * @note Each move shifts the slots between its old and new position, so past this
+         *       count a full sort is cheaper whatever the size of the list.
+         */
+        static constexpr size_t INCREMENTAL_REORDER_LIMIT = 64;
+
+        /**
+         * @brief Maximum number of dirty handlers per list entry for which a merge reorder is used.
+         * 
+         * @note Above this fraction a full sort is used instead.
+         */
+        static constexpr double MERGE_REORDER_RATIO = 0.3;
+
+        /**
+         * @brief Maximum estimated local reorder cost per list entry for which it is used.
+         * 
+         * @note The cost is the number of dirty handlers times their displacement; a merge
+         *       reorder walks the whole list instead.
+         */
+        static constexpr double LOCAL_REORDER_RATIO = 0.5;
+
+        /**
+         * @brief Number of dirty handlers sampled to estimate their displacement.
+         */
+        static constexpr size_t DISPLACEMENT_SAMPLES = 32;
+
+        /**
+         * @brief Fraction of the list above which the order indices are uploaded in full.
+         */
+        static constexpr double FULL_UPLOAD_RATIO = 0.5;
+
+        /**
+         * @brief Smallest capacity of the index indirection SSBO, in order indices.
+         */
+        static constexpr size_t MIN_INDIRECTION_CAPACITY = 1024;
+
+        /**
+         * @brief Get the index indirection SSBO capacity for a list size.
+         * 
+         * @param capacity Current capacity, 0 if the SSBO is not allocated yet.
+         * @param size Number of order indices to hold.
+         * @return The new capacity.
+         * 
+         * @note Doubles until the size fits and halves once the size drops below a quarter,
+         *       never going under MIN_INDIRECTION_CAPACITY.
+         */
+        static size_t GetIndirectionCapacity(size_t capacity, size_t size);
+
+        /**
+         * @brief Get the bucket key of a batch key.
+         * 
+         * @param key Batch key of the handler.
+         * @param zRange Width of the z ranges sharing a bucket, 0 for one bucket per z value.
+         * @return The sort key with its z-index rounded down to a multiple of zRange.
+         * 
+         * @note Handlers of one z range are only ordered by program and texture.
+         */
+        static uint64_t GetBucketKey(const BatchKey& key, float zRange);
+
+        /**
+         * @brief Order index marking an erased slot.
+         */
+        static constexpr unsigned int TOMBSTONE = UINT_MAX;
+
+        /**
+         * @brief Order position of a batch index not in the render list.
+         */
+        static constexpr unsigned int NO_POSITION = UINT_MAX;
+
         /**
          * @brief Constructor for RenderList.
          * 
@@ -331,6 +697,7 @@ class RenderList {
          * @return Reference to the GraphicBatchHandler.
          * 
          * @note Used for accessing batch handlers based on order indices.
+         * @throws std::runtime_error if the slot is out of range or was erased since the last compaction.
          */
         GraphicBatchHandler& getIndirectHandler(size_t index);
 
@@ -345,6 +712,55 @@ class RenderList {
          */
         GraphicBatchHandler& createHandler(BatchKey key, Graphic2D* graphic, InstanceAllocator& instanceAllocator);
 
+        /**
+         * @brief Append a batch index to the render list.
+         * 
+         * @param index Batch index of the handler to append.
+         * 
+         * @note Marks the handler dirty if it breaks the ordering.
+         */
+        void insert(unsigned int index);
+
+        /**
+         * @brief Remove a batch index from the render list.
+         * 
+         * @param index Batch index of the handler to remove.
+         * 
+         * @note Constant time: the slot becomes a tombstone dropped by the next compaction.
+         *       Bucketed lists instead move the handler past the last bucket and drop it.
+         */
+        void remove(unsigned int index);
+
+        /**
+         * @brief Get the slot of a batch index in the order indices.
+         * 
+         * @param index Batch index of the handler.
+         * @return Slot in the order indices, or NO_POSITION if not in the render list.
+         */
+        unsigned int getPosition(unsigned int index) const;
+
+        /**
+         * @brief Check if the render list holds a batch index.
+         * 
+         * @param index Batch index of the handler.
+         * @return true if the handler is in the render list, false otherwise.
+         */
+        bool contains(unsigned int index) const;
+
+        /**
+         * @brief Check if the render list holds tombstones.
+         * 
+         * @return true if compaction is needed, false otherwise.
+         */
+        bool needsCompaction() const;
+
+        /**
+         * @brief Drop the tombstones left by erased handlers.
+         * 
+         * @note Must run before the render list is iterated or reordered.
+         */
+        void compact();
+
         /**
          * @brief Check if the render list is empty.
          * 
@@ -367,6 +783,16 @@ class RenderList {
          */
         void erase(GraphicBatchHandler& handler, InstanceAllocator& instanceAllocator);
 
+        /**
+         * @brief Follow a handler moved to another index of the batch buffer.
+         * 
+         * @param from Previous index of the handler.
+         * @param to New index of the handler, not in the render list.
+         * 
+         * @note Keeps its slot in the order; only that slot is uploaded again.
+         */
+        void relocate(unsigned int from, unsigned int to);
+
         /**
          * @brief Bind the index indirection SSBO.
          */
@@ -389,28 +815,106 @@ class RenderList {
         /**
          * @brief Reorder the render list.
          * 
-         * @note Chooses the appropriate reordering method based on the number of dirty handlers.
+         * @note Chooses the appropriate reordering method based on the number of dirty handlers
+         *       and the size of the list.
          */
         void reorder();
 
+        /**
+         * @brief Set the number of threads used to sort large lists.
+         * 
+         * @param count Number of threads, 1 to always sort serially, 0 for the hardware concurrency.
+         * 
+         * @note Lists below RadixSorter::PARALLEL_THRESHOLD are always sorted serially.
+         */
+        void setSortThreadCount(unsigned int count);
+
+        /**
+         * @brief Switch the render list to or from the bucketed mode.
+         * 
+         * @param enabled Whether to bucket the render list.
+         * @param zRange Width of the z ranges sharing a bucket, 0 for one bucket per z value.
+         * 
+         * @note Suits scenes with few distinct z layers: a z change then moves the handler
+         *       across the buckets in between instead of shifting the slots in between.
+         *       Sorts the whole list once.
+         */
+        void setBucketed(bool enabled, float zRange = 0.0f);
+
+        /**
+         * @brief Check if the render list is bucketed.
+         * 
+         * @return true if the render list is bucketed, false otherwise.
+         */
+        bool isBucketed() const { return bucketed; }
+
+        /**
+         * @brief Get the buckets of the render list.
+         * 
+         * @return Reference to the bucket buffer, empty unless the render list is bucketed.
+         */
+        const RenderBucketBuffer& getBuckets() const { return buckets; }
+
         /**
          * @brief Mark a graphic batch handler as dirty.
          * 
          * @param handler Reference to the GraphicBatchHandler to mark as dirty.
          * 
-         * @note Adds the handler to the dirty handlers buffer.
+         * @note Adds the handler to the dirty indices buffer once per reorder.
          */
         void markDirty(GraphicBatchHandler& handler);
 
+        /**
+         * @brief Get the slots changed since the last upload.
+         * 
+         * @return Range of changed slots, empty if nothing changed.
+         */
+        Region getUploadRange() const;
+
+        /**
+         * @brief Get the ranges of slots to upload.
+         * 
+         * @return Sorted, disjoint ranges of slots, empty if nothing changed.
+         * 
+         * @note Bridges gaps cheaper to send than an extra call and falls back to the whole
+         *       list once more than FULL_UPLOAD_RATIO of it changed.
+         */
+        const std::vector<Region>& getUploadRegions();
+
         /**
          * @brief Upload the order indices to the SSBO.
+         * 
+         * @note Only the ranges returned by getUploadRegions are sent, one call each.
          */
         void uploadOrderIndices();
 
+        /**
+         * @brief Check if the draw commands must be rebuilt.
+         * 
+         * @return True if the order or a batch key changed since the last build.
+         */
+        bool needsDrawCommandsRebuild() const;
+
+        /**
+         * @brief Build the draw commands of the render list.
+         * 
+         * @param compatible Predicate telling whether two adjacent handlers share a draw call.
+         * 
+         * @note The render list must be compacted and reordered first.
+         */
+        void buildDrawCommands(const BatchCompatibility& compatible);
+
+        /**
+         * @brief Get the draw commands of the render list.
+         * 
+         * @return Reference to the draw command buffer.
+         */
+        const DrawCommandBuffer& getDrawCommands() const { return drawCommands; }
+
         /**
          * @brief Get the size of the render list.
          * 
-         * @return The number of graphic batch handlers in the render list.
+         * @return The number of slots in the render list, tombstones included.
          */
         size_t size() const { return orderIndices.size(); }
 
@@ -418,6 +922,8 @@ class RenderList {
          * @brief Begin iterator for the render list.
          * 
          * @return IndirectIterator to the beginning of the render list.
+         * 
+         * @note Erased slots are skipped, the iteration is safe between compactions.
          */
         IndirectIterator begin() { return IndirectIterator(batch, orderIndices, 0); }
 
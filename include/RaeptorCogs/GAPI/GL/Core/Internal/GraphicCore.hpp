@@ -63,15 +63,6 @@ constexpr int INSTANCE_SIZE = 32;
  * @brief Height of the instance data texture.
  */
 constexpr int IDATATEX_HEIGHT = (MAX_SPRITES * INSTANCE_SIZE + 16 * IDATATEX_WIDTH - 1) / (16 * IDATATEX_WIDTH);
-#else
-/**
- * @brief Default size of the dynamic instance data buffer.
- */
-constexpr int DEFAULT_DYNAMIC_DATA_BUFFER_SIZE = (MAX_SPRITES * INSTANCE_SIZE);
-/**
- * @brief Size of the static instance data buffer.
- */
-constexpr int STATIC_INSTANCE_DATA_SIZE = (MAX_SPRITES * sizeof(Common::StaticInstanceData));
 #endif
 
 class GraphicCore : public Common::GraphicCore {
@@ -42,6 +42,7 @@
 #include <RaeptorCogs/Renderer.hpp>
 #include <RaeptorCogs/Shape.hpp>
 #include <RaeptorCogs/Node.hpp>
+#include <RaeptorCogs/Transform.hpp>
 #include <RaeptorCogs/GAPI/Common/Core/GraphicHandler.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
@@ -64,7 +65,11 @@ enum class GraphicFlags : uint32_t {
     /** Flag to indicate if the graphic should inherit read mask from parent */
     INHERIT_READ_MASK = 1 << 1,
     /** Flag to disable batching for this graphic (disables batch processing for this graphic - used by text) */
-    NO_BATCHING = 1 << 2
+    NO_BATCHING = 1 << 2,
+    /** Flag to indicate if the state inherited from the parent must be pulled again */
+    INHERITED_DIRTY = 1 << 3,
+    /** Flag to indicate if the children still have to be marked for an instance data rebuild */
+    CHILDREN_DIRTY = 1 << 4
 };
 
 /**
@@ -139,8 +144,74 @@ class Graphic2D : public RegisterNode<Graphic2D, Node>, public FlagSet<GraphicFl
          */
         int writingMaskIndex = 0;
 
+        /**
+         * @brief Version of the state the children inherit.
+         * 
+         * Bumped each time the inherited state is pulled with changes.
+         */
+        uint32_t version = 0;
+
+        /**
+         * @brief Version of the parent when the inherited state was last pulled.
+         */
+        uint32_t parentVersion = 0;
+
+    protected:
+
+        // ============================================================================
+        //                               PROTECTED METHODS
+        // ============================================================================
+
+        /**
+         * @brief Recompute the state inherited from the parent.
+         * 
+         * @param parent Parent graphic, nullptr for roots.
+         * 
+         * @note Called by refreshInherited once the parent is up to date. Overrides must
+         *       call the base implementation.
+         */
+        virtual void inheritFrom(Graphic2D* parent);
+
+        /**
+         * @brief Mark the state the children inherit as changed.
+         * 
+         * @note Constant time: the children pull the new state when they read it.
+         */
+        void setInheritedDirty();
+
+        /**
+         * @brief Mark the instance data of the children as stale.
+         * 
+         * @note Constant time for graphics in a render list: the render pipeline calls
+         *       markChildrenDirty when it updates this graphic, once per frame. Graphics
+         *       outside the render lists mark their children right away.
+         */
+        void setChildrenDirty();
+
+        /**
+         * @brief Set the parent node of the graphic.
+         * 
+         * @param parent Pointer to the parent node.
+         * 
+         * @note This method overrides the base class implementation to handle graphic-specific parent setting.
+         *       Protected like the base one, use addChild and removeChild.
+         */
+        void setParent(Node* parent) override;
+
     public:
 
+        // ============================================================================
+        //                               PUBLIC CONSTANTS
+        // ============================================================================
+
+        /**
+         * @brief Largest mask ID a graphic can read or write.
+         * 
+         * @note Written masks are read by the children, so both share the batch key limit,
+         *       which also fits the compact instance layout.
+         */
+        static constexpr int MAX_MASK_ID = static_cast<int>(BatchKey::MAX_READING_MASK);
+
         // ============================================================================
         //                               PUBLIC METHODS
         // ============================================================================
@@ -151,6 +222,7 @@ class Graphic2D : public RegisterNode<Graphic2D, Node>, public FlagSet<GraphicFl
         Graphic2D() {
             FlagSet<GraphicFlags>::setFlag(GraphicFlags::DATA_DIRTY);
             FlagSet<GraphicFlags>::setFlag(GraphicFlags::INHERIT_READ_MASK);
+            FlagSet<GraphicFlags>::setFlag(GraphicFlags::INHERITED_DIRTY);
         };
 
         /**
@@ -212,17 +284,22 @@ class Graphic2D : public RegisterNode<Graphic2D, Node>, public FlagSet<GraphicFl
         /**
          * @brief Set the reading mask ID.
          * 
-         * @param index Reading mask index.
+         * @param index Reading mask index, from 0 to MAX_MASK_ID.
          * @param inheritFromParent Whether to inherit the reading mask from the parent graphic.
          * 
+         * @throws std::runtime_error if the index is out of range.
+         * 
          * @note If inheritFromParent is true, the reading mask will only be applied if no reading mask was already set.
+         *       Children without a reading mask of their own pull it when they read theirs.
          */
         void setReadingMaskID(int index, bool inheritFromParent = false);
 
         /**
          * @brief Set the writing mask ID.
          * 
-         * @param index Writing mask index.
+         * @param index Writing mask index, from 0 to MAX_MASK_ID.
+         * 
+         * @throws std::runtime_error if the index is out of range.
          */
         void setWritingMaskID(int index);
 
@@ -276,8 +353,33 @@ class Graphic2D : public RegisterNode<Graphic2D, Node>, public FlagSet<GraphicFl
          * @brief Get the reading mask ID.
          * 
          * @return Reading mask index.
+         * 
+         * @note Pulls the mask inherited from the parent first if it changed.
+         */
+        int getReadingMaskID();
+
+        /**
+         * @brief Pull the state inherited from the parent if it changed.
+         * 
+         * @note Refreshes the ancestors first, then compares the parent version with the
+         *       one last pulled.
+         */
+        void refreshInherited();
+
+        /**
+         * @brief Mark the instance data of the children as stale, if it changed since the last call.
+         * 
+         * @note Called by the render pipeline when it updates this graphic; the children are
+         *       reached in the same pass, each level once.
          */
-        int getReadingMaskID() const;
+        void markChildrenDirty();
+
+        /**
+         * @brief Get the version of the state the children inherit.
+         * 
+         * @return Version, changed whenever that state did.
+         */
+        uint32_t getVersion() const { return this->version; }
 
         /**
          * @brief Get the texture associated with the graphic.
@@ -332,18 +434,9 @@ class Graphic2D : public RegisterNode<Graphic2D, Node>, public FlagSet<GraphicFl
          * @return BatchKey object.
          * 
          * @note The renderer key is used for ordering and batching graphics during rendering.
+         *       The texture goes in as its slot in the render pipeline, see BatchKeySlots.
          */
-        BatchKey buildRendererKey() {
-            return BatchKey{
-                !!this->getWritingMaskID(),
-                this->getWritingMaskID() ? this->getReadingMaskID() : 0,
-                static_cast<int>(this->getWritingMaskID() ? -this->getZIndex() : this->getZIndex()),
-                this->getWritingMaskID() ? false : this->isOpaque(),
-                /** TODO: For now program is always the same. Update when multiple programs are supported. */
-                this->getProgramID(),
-                this->getID()
-            };
-        }
+        BatchKey buildRendererKey();
 
         /**
          * @brief Set the data dirty flag.
@@ -363,15 +456,6 @@ class Graphic2D : public RegisterNode<Graphic2D, Node>, public FlagSet<GraphicFl
          */
         bool isDataDirty() const;
 
-        /**
-         * @brief Set the parent node of the graphic.
-         * 
-         * @param parent Pointer to the parent node.
-         * 
-         * @note This method overrides the base class implementation to handle graphic-specific parent setting.
-         */
-        void setParent(Node* parent) override;
-
         /**
          * @brief Update the graphic's position in the render lists.
          * 
@@ -422,6 +506,28 @@ class RenderableGraphic2D : public RegisterNode<RenderableGraphic2D, Graphic2D>,
          */
         std::shared_ptr<Shape> shape = std::make_shared<Quad>();
 
+    protected:
+
+        // ============================================================================
+        //                               PROTECTED METHODS
+        // ============================================================================
+
+        /**
+         * @brief Recompute the mask and global color inherited from the parent.
+         * 
+         * @param parent Parent graphic, nullptr for roots.
+         */
+        void inheritFrom(Graphic2D* parent) override;
+
+        /**
+         * @brief Set the parent node of the graphic.
+         * 
+         * @param parent Pointer to the parent node.
+         * 
+         * @note This method overrides the base class implementation to handle graphic-specific parent setting.
+         */
+        void setParent(Node* parent) override;
+
     public:
 
         // ============================================================================
@@ -487,7 +593,8 @@ class RenderableGraphic2D : public RegisterNode<RenderableGraphic2D, Graphic2D>,
         /**
          * @brief Rebuild the global color of the graphic.
          * 
-         * @note The global color is computed by combining the graphic's color with its parent's global color.
+         * @note The global color is computed by combining the graphic's color with its parent's global color,
+         *       pulled again only when either changed.
          */
         void rebuildGlobalColor();
 
@@ -516,6 +623,8 @@ class RenderableGraphic2D : public RegisterNode<RenderableGraphic2D, Graphic2D>,
          * @brief Set the global color dirty flag.
          * 
          * @param dirty Boolean indicating if the global color is dirty.
+         * 
+         * @note The children are not walked, they compare versions when they read their color.
          */
         void setGlobalColorDirty(bool dirty);
 
@@ -525,15 +634,6 @@ class RenderableGraphic2D : public RegisterNode<RenderableGraphic2D, Graphic2D>,
          * @return True if the global color is dirty, false otherwise.
          */
         bool isGlobalColorDirty() const;
-
-        /**
-         * @brief Set the parent node of the graphic.
-         * 
-         * @param parent Pointer to the parent node.
-         * 
-         * @note This method overrides the base class implementation to handle graphic-specific parent setting.
-         */
-        void setParent(Node* parent) override;
 };
 
 /**
@@ -568,53 +668,41 @@ class TransformableGraphic2D : public RegisterNode<TransformableGraphic2D, Rende
         // ============================================================================
 
         /**
-         * @brief Local transformation matrix.
+         * @brief Transform of the graphic.
          * 
-         * Used to represent the graphic transform in its local space.
-         */
-        glm::mat4 localMatrix = glm::mat4(1.0f);
-
-        /**
-         * @brief Global transformation matrix.
+         * Identifies its local components and global matrix in the transform hierarchy.
          * 
-         * Used to represent the graphic transform in world space.
+         * @see RaeptorCogs::Transforms
          */
-        glm::mat4 globalMatrix = glm::mat4(1.0f);
+        TransformID transformID;
 
-        /**
-         * @brief Position of the graphic.
-         * 
-         * Defines the position in 2D space.
-         */
-        glm::vec2 position = glm::vec2(0.0f, 0.0f);
+        // ============================================================================
+        //                               PRIVATE METHODS
+        // ============================================================================
 
         /**
-         * @brief Size of the graphic.
+         * @brief Get the transform hierarchy parent of a node.
          * 
-         * Defines the width and height.
+         * @param parent Parent node, may be null.
+         * @return Transform of the parent, NO_TRANSFORM unless it is a TransformableGraphic2D.
          */
-        glm::vec2 size = glm::vec2(1.0f, 1.0f);
+        static TransformID GetParentTransform(Node* parent);
 
-        /**
-         * @brief Scale of the graphic.
-         * 
-         * Defines the scaling factors along x and y axes.
-         */
-        glm::vec2 scale = glm::vec2(1.0f, 1.0f);
+    protected:
 
-        /**
-         * @brief Rotation of the graphic.
-         * 
-         * Defines the rotation angle in radians.
-         */
-        float rotation = 0.0f;
+        // ============================================================================
+        //                               PROTECTED METHODS
+        // ============================================================================
 
         /**
-         * @brief Anchor point of the graphic.
+         * @brief Set the parent node of the graphic.
+         * 
+         * @param parent Pointer to the parent node.
          * 
-         * Defines the pivot point for transformations.
+         * @note This method overrides the base class implementation to handle graphic-specific parent setting.
          */
-        glm::vec2 anchor = glm::vec2(0.0f, 0.0f);
+        void setParent(Node* parent) override;
+
     public:
 
         // ============================================================================
@@ -624,29 +712,41 @@ class TransformableGraphic2D : public RegisterNode<TransformableGraphic2D, Rende
         /**
          * @brief Default constructor for TransformableGraphic2D.
          * 
-         * Initializes the local and global matrices as dirty.
+         * Creates its transform and initializes the local and global matrices as dirty.
          */
-        TransformableGraphic2D() {
-            FlagSet<TransformFlags>::setFlag(TransformFlags::LOCAL_MATRIX_DIRTY);
-            FlagSet<TransformFlags>::setFlag(TransformFlags::GLOBAL_MATRIX_DIRTY);
-        };
+        TransformableGraphic2D();
 
         /**
-         * @brief Destructor for TransformableGraphic2D.
+         * @brief Copy constructor for TransformableGraphic2D.
+         * 
+         * @param other Graphic to copy.
+         * 
+         * @note Creates a transform of its own with the same components. Like the node,
+         *       the copy starts without parent.
          */
-        ~TransformableGraphic2D() = default;
+        TransformableGraphic2D(const TransformableGraphic2D& other);
 
         /**
-         * @brief Rebuild the local transformation matrix.
+         * @brief Copy assignment operator for TransformableGraphic2D.
+         * 
+         * @param other Graphic to copy.
+         * @return Reference to this graphic.
          * 
-         * @note This method recalculates the local matrix based on position, size, scale, rotation, and anchor point.
+         * @note Copies the components into its own transform. Like the node, it keeps its own parent.
          */
-        void rebuildLocalMatrix();
+        TransformableGraphic2D& operator=(const TransformableGraphic2D& other);
+
+        /**
+         * @brief Destructor for TransformableGraphic2D.
+         * 
+         * Detaches the transforms of its children and destroys its own.
+         */
+        ~TransformableGraphic2D();
 
         /**
          * @brief Rebuild the global transformation matrix.
          * 
-         * @note This method recalculates the global matrix by combining the local matrix with the parent's global matrix.
+         * @note Updates the dirty subtrees of the whole transform hierarchy in one pass.
          */
         void rebuildGlobalMatrix();
 
@@ -739,42 +839,37 @@ class TransformableGraphic2D : public RegisterNode<TransformableGraphic2D, Rende
          */
         void setZIndex(float z) override;
 
-        /**
-         * @brief Set the parent node of the graphic.
-         * 
-         * @param parent Pointer to the parent node.
-         * 
-         * @note This method overrides the base class implementation to handle graphic-specific parent setting.
-         */
-        void setParent(Node* parent) override;
-
         /**
          * @brief Get the model matrix of the graphic.
          * 
          * @return Model matrix (global transformation matrix).
          * 
          * @note The model matrix represents the graphic's transformation in world space.
+         *       Read from the transform hierarchy, updated first if needed.
          */
         glm::mat4 getModelMatrix();
 
         /**
          * @brief Get the local transformation matrix.
          * 
-         * @return Reference to the local transformation matrix.
+         * @return Local transformation matrix, built from the components.
          */
-        glm::mat4 &getLocalMatrix();
+        glm::mat4 getLocalMatrix() const;
 
         /**
-         * @brief Get the global transformation matrix.
+         * @brief Get the transform of the graphic.
          * 
-         * @return Reference to the global transformation matrix.
+         * @return Identifier of the graphic in the transform hierarchy.
          */
-        glm::mat4 &getGlobalMatrix();
+        TransformID getTransformID() const { return transformID; }
 
         /**
          * @brief Set the local matrix dirty flag.
          * 
          * @param dirty New state of the local matrix dirty flag.
+         * 
+         * @note The children are not walked: the transform hierarchy rebuilds their matrices
+         *       and the render pipeline marks their instance data once per frame.
          */
         void setLocalMatrixDirty(bool dirty);
 
@@ -782,6 +877,8 @@ class TransformableGraphic2D : public RegisterNode<TransformableGraphic2D, Rende
          * @brief Set the global matrix dirty flag.
          * 
          * @param dirty New state of the global matrix dirty flag.
+         * 
+         * @note The children are not walked, as for setLocalMatrixDirty.
          */
         void setGlobalMatrixDirty(bool dirty);
 
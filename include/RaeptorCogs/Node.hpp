@@ -39,7 +39,8 @@
 
 #pragma once
 #include <RaeptorCogs/BitArray.hpp>
-#include <vector>
+#include <cstddef>
+#include <iterator>
 
 namespace RaeptorCogs {
 
@@ -72,11 +73,25 @@ class Node {
         Node* parent = nullptr;
 
         /**
-         * @brief Child nodes vector.
+         * @brief First and last child nodes.
          * 
-         * Stores pointers to the child nodes of this node.
+         * Ends of the intrusive list of children, linked through their sibling pointers.
          */
-        std::vector<Node*> children;
+        Node* firstChild = nullptr;
+        Node* lastChild = nullptr;
+
+        /**
+         * @brief Previous and next sibling nodes.
+         * 
+         * Links in the list of children of the parent.
+         */
+        Node* previousSibling = nullptr;
+        Node* nextSibling = nullptr;
+
+        /**
+         * @brief Number of child nodes.
+         */
+        size_t childCount = 0;
 
         /**
          * @brief Get the next unique class ID.
@@ -88,6 +103,24 @@ class Node {
             return id++;
         }
 
+        /**
+         * @brief Link a child node at the end of the list of children.
+         * 
+         * @param child Child node to link, not linked anywhere.
+         * 
+         * @note Constant time. Leaves the parent pointer of the child alone.
+         */
+        void linkChild(Node* child);
+
+        /**
+         * @brief Unlink a child node from the list of children.
+         * 
+         * @param child Child node to unlink, whose parent is this node.
+         * 
+         * @note Constant time. Leaves the parent pointer of the child alone.
+         */
+        void unlinkChild(Node* child);
+
     protected:
 
         // ============================================================================
@@ -99,12 +132,76 @@ class Node {
          * 
          * @param parent Pointer to the parent node.
          * 
-         * @note Called internally when adding/removing child nodes.
+         * @note Called internally when adding/removing child nodes. Moves the node from the
+         *       children of its old parent to the end of those of the new one, so overrides
+         *       must call it.
          */
         virtual void setParent(Node* parent);
 
     public:
 
+        /**
+         * @brief Forward iterator over the children of a node.
+         * 
+         * @note Reads the next sibling ahead, so the current child may be removed.
+         */
+        class ChildIterator {
+            private:
+                Node* node;
+                Node* next;
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Node*;
+                using difference_type = std::ptrdiff_t;
+                using pointer = Node* const*;
+                using reference = Node* const&;
+
+                explicit ChildIterator(Node* node) : node(node), next(node ? node->nextSibling : nullptr) {}
+                reference operator*() const { return node; }
+                ChildIterator& operator++() {
+                    node = next;
+                    next = node ? node->nextSibling : nullptr;
+                    return *this;
+                }
+                ChildIterator operator++(int) {
+                    ChildIterator previous = *this;
+                    ++*this;
+                    return previous;
+                }
+                bool operator==(const ChildIterator& other) const { return node == other.node; }
+                bool operator!=(const ChildIterator& other) const { return node != other.node; }
+        };
+
+        /**
+         * @brief Range over the children of a node, in insertion order.
+         * 
+         * @note A view: it allocates nothing and sees later additions and removals.
+         */
+        class ChildRange {
+            private:
+                const Node* node;
+            public:
+                explicit ChildRange(const Node* node) : node(node) {}
+                ChildIterator begin() const { return ChildIterator(node->firstChild); }
+                ChildIterator end() const { return ChildIterator(nullptr); }
+                size_t size() const { return node->childCount; }
+                bool empty() const { return node->childCount == 0; }
+
+                /**
+                 * @brief Get a child by position.
+                 * 
+                 * @param index Position of the child, less than size().
+                 * @return Pointer to the child.
+                 * 
+                 * @note Linear in the position: walks the siblings.
+                 */
+                Node* operator[](size_t index) const {
+                    Node* child = node->firstChild;
+                    while (index--) child = child->nextSibling;
+                    return child;
+                }
+        };
+
         // ============================================================================
         //                               PUBLIC METHODS
         // ============================================================================
@@ -114,19 +211,61 @@ class Node {
          */
         Node() = default;
 
+        /**
+         * @brief Copy constructor for Node.
+         * 
+         * @param other Node to copy.
+         * 
+         * @note The copy starts detached: parent and children stay with the original.
+         */
+        Node(const Node& other);
+
+        /**
+         * @brief Copy assignment operator for Node.
+         * 
+         * @param other Node to copy.
+         * @return Reference to this node.
+         * 
+         * @note Keeps the parent and children of this node.
+         */
+        Node& operator=(const Node& other);
+
         /**
          * @brief Destructor for Node.
+         * 
+         * Unlinks the node from its parent and detaches its children.
          */
         virtual ~Node();
 
+        /**
+         * @brief Get the class IDs of the Node class.
+         * 
+         * @return BitArray with the class ID of Node set, built once.
+         */
+        static const BitArray& GetClassMask() {
+            static const BitArray classIds = BitArray().set(getClassId<Node>());
+            return classIds;
+        }
+
+        /**
+         * @brief Get the class IDs of the dynamic type of this node.
+         * 
+         * @return Reference to the BitArray of its class and all its bases, shared by all
+         *         the instances of the class.
+         */
+        virtual const BitArray& getClassMask() const {
+            return Node::GetClassMask();
+        }
+
         /**
          * @brief Get the class IDs BitArray for this node.
          * 
          * @return BitArray representing the class IDs of this node.
+         * 
+         * @note Copies getClassMask, prefer it or isInstanceOf on hot paths.
          */
-        virtual BitArray getClassIds() const {
-            BitArray classIds;
-            return classIds.set(getClassId<Node>());
+        BitArray getClassIds() const {
+            return this->getClassMask();
         }
 
         /**
@@ -138,10 +277,11 @@ class Node {
          * @code{.cpp}
          * bool isMyNode = node->isInstanceOf<MyNode>(); // true if node is of type MyNode
          * @endcode
+         * @note Tests one bit of the class mask, no allocation.
          */
         template<typename T>
         bool isInstanceOf() const {
-            return this->getClassIds().test(Node::getClassId<T>());
+            return this->getClassMask().test(Node::getClassId<T>());
         }
 
         /**
@@ -149,7 +289,8 @@ class Node {
          * 
          * @param child Pointer to the child node to add.
          * 
-         * @note Sets the parent of the child node to this node.
+         * @note Sets the parent of the child node to this node. Constant time; a child of
+         *       another node is moved, appended after the last child.
          */
         void addChild(Node* child);
 
@@ -158,18 +299,19 @@ class Node {
          * 
          * @param child Pointer to the child node to remove.
          * 
-         * @note Sets the parent of the child node to nullptr.
+         * @note Sets the parent of the child node to nullptr. Constant time, does nothing if
+         *       the node is not a child of this one.
          */
         void removeChild(Node* child);
 
         /**
          * @brief Get the child nodes.
          * 
-         * @return Vector of pointers to the child nodes.
+         * @return Range over the children, in the order they were added.
          * 
-         * @note The returned vector is const to prevent modification of the child nodes.
+         * @note The range is read-only, use addChild and removeChild to change the children.
          */
-        const std::vector<Node*>& getChildren() const;
+        ChildRange getChildren() const;
 
         /**
          * @brief Get the parent node.
@@ -209,14 +351,22 @@ template<typename Derived, typename Base>
 struct RegisterNode : Base {
 
     /**
-     * @brief Get the class IDs BitArray for this node.
+     * @brief Get the class IDs of the Derived class.
+     * 
+     * @return BitArray of the Base class IDs with the Derived one set, built once.
+     */
+    static const BitArray& GetClassMask() {
+        static const BitArray classIds = BitArray(Base::GetClassMask()).set(Node::getClassId<Derived>());
+        return classIds;
+    }
+
+    /**
+     * @brief Get the class IDs of the dynamic type of this node.
      * 
-     * @return BitArray representing the class IDs of this node.
+     * @return Reference to the BitArray of the Derived class.
      */
-    BitArray getClassIds() const override {
-        BitArray bits = Base::getClassIds();
-        bits.set(Node::getClassId<Derived>());
-        return bits;
+    const BitArray& getClassMask() const override {
+        return RegisterNode::GetClassMask();
     }
 };
 
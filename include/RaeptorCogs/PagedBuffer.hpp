@@ -0,0 +1,240 @@
+/** ********************************************************************************
+ * @section PagedBuffer_Overview Overview
+ * @file PagedBuffer.hpp
+ * @brief Paged array storage utilities.
+ * @details
+ * Typical use cases:
+ * - Growing large CPU-side buffers without reallocating or copying them.
+ * - Keeping references to elements valid while the buffer grows.
+ * *********************************************************************************
+ * @section PagedBuffer_Header Header
+ * <RaeptorCogs/PagedBuffer.hpp>
+ ***********************************************************************************
+ * @section PagedBuffer_Metadata Metadata
+ * @author Estorc
+ * @version v1.0
+ * @copyright Copyright (c) 2025 Estorc MIT License.
+ **********************************************************************************/
+/*                             This file is part of
+ *                                  RaeptorCogs
+ *                     (https://github.com/Estorc/RaeptorCogs)
+ ***********************************************************************************
+ * Copyright (c) 2025 Estorc.
+ * This file is licensed under the MIT License.
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ***********************************************************************************/
+
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace RaeptorCogs {
+
+/**
+ * @brief PagedBuffer class template.
+ * 
+ * Array split into fixed-size pages. Growing only appends pages, so existing
+ * elements are never copied and references to them stay valid.
+ * 
+ * @tparam T Element type.
+ * @tparam PageBytes Maximum page size in bytes.
+ * 
+ * @code{.cpp}
+ * RaeptorCogs::PagedBuffer<float> buffer;
+ * buffer.resize(100000);                           // Appends pages, no copy
+ * float& value = buffer[42];                       // Stays valid across resizes
+ * buffer.forEachSpan(0, buffer.size(), [](size_t first, const float* data, size_t count) {
+ *     // Contiguous elements [first, first + count)
+ * });
+ * @endcode
+ * 
+ * @note Element i sits at byte i * sizeof(T) of the equivalent flat array, so pages
+ *       map directly to ranges of a GPU buffer holding the same elements.
+ */
+template<typename T, size_t PageBytes = (1 << 16)>
+class PagedBuffer {
+    public:
+
+        // ============================================================================
+        //                               PUBLIC CONSTANTS
+        // ============================================================================
+
+        /**
+         * @brief Number of elements in a page.
+         * 
+         * @note Largest power of two fitting PageBytes, so indexing is a shift and a mask.
+         */
+        static constexpr size_t PAGE_SIZE = [] {
+            size_t count = 1;
+            while (count * 2 * sizeof(T) <= PageBytes) count *= 2;
+            return count;
+        }();
+
+    private:
+
+        // ============================================================================
+        //                               PRIVATE ATTRIBUTES
+        // ============================================================================
+
+        /**
+         * @brief Allocated pages.
+         * 
+         * @note Pages are kept when the buffer shrinks, and reused when it grows again.
+         */
+        std::vector<std::unique_ptr<T[]>> pages;
+
+        /**
+         * @brief Number of elements in use.
+         */
+        size_t count = 0;
+
+    public:
+
+        // ============================================================================
+        //                               PUBLIC METHODS
+        // ============================================================================
+
+        /**
+         * @brief Default constructor for PagedBuffer.
+         */
+        PagedBuffer() = default;
+
+        /**
+         * @brief Get the number of elements in use.
+         * 
+         * @return Element count.
+         */
+        size_t size() const { return count; }
+
+        /**
+         * @brief Check if the buffer holds no element.
+         * 
+         * @return true if empty, false otherwise.
+         */
+        bool empty() const { return count == 0; }
+
+        /**
+         * @brief Get the number of allocated pages.
+         * 
+         * @return Page count.
+         */
+        size_t pageCount() const { return pages.size(); }
+
+        /**
+         * @brief Resize the buffer.
+         * 
+         * @param newSize New element count.
+         * 
+         * @note New elements are value-initialized; existing ones are neither moved nor copied.
+         */
+        void resize(size_t newSize) {
+            // Pages kept from a previous shrink may hold stale elements
+            size_t reusedEnd = std::min(newSize, pages.size() * PAGE_SIZE);
+            for (size_t index = count; index < reusedEnd; ++index) {
+                (*this)[index] = T();
+            }
+            size_t neededPages = (newSize + PAGE_SIZE - 1) / PAGE_SIZE;
+            while (pages.size() < neededPages) {
+                pages.push_back(std::make_unique<T[]>(PAGE_SIZE));
+            }
+            count = newSize;
+        }
+
+        /**
+         * @brief Check whether a range spans more than one page.
+         * 
+         * @param begin First element of the range.
+         * @param size Number of elements in the range.
+         * @return true if the range crosses a page boundary, false otherwise.
+         * 
+         * @note Pointers into the buffer are only contiguous within a page.
+         */
+        static bool crossesPage(size_t begin, size_t size) {
+            return size > 0 && begin / PAGE_SIZE != (begin + size - 1) / PAGE_SIZE;
+        }
+
+        /**
+         * @brief Release the pages past the ones in use.
+         */
+        void shrinkToFit() {
+            pages.resize((count + PAGE_SIZE - 1) / PAGE_SIZE);
+        }
+
+        /**
+         * @brief Remove every element and release the pages.
+         */
+        void clear() {
+            pages.clear();
+            count = 0;
+        }
+
+        /**
+         * @brief Access an element.
+         * 
+         * @param index Element index, below size().
+         * @return Reference to the element.
+         */
+        T& operator[](size_t index) {
+            return pages[index / PAGE_SIZE][index % PAGE_SIZE];
+        }
+
+        /**
+         * @brief Access an element.
+         * 
+         * @param index Element index, below size().
+         * @return Const reference to the element.
+         */
+        const T& operator[](size_t index) const {
+            return pages[index / PAGE_SIZE][index % PAGE_SIZE];
+        }
+
+        /**
+         * @brief Visit a range as contiguous spans, one per page it covers.
+         * 
+         * @param begin First element of the range.
+         * @param end End of the range, clamped to size().
+         * @param callback Called as callback(first, data, count) for each span.
+         */
+        template<typename Callback>
+        void forEachSpan(size_t begin, size_t end, Callback&& callback) const {
+            end = std::min(end, count);
+            while (begin < end) {
+                size_t offset = begin % PAGE_SIZE;
+                size_t spanSize = std::min(PAGE_SIZE - offset, end - begin);
+                callback(begin, pages[begin / PAGE_SIZE].get() + offset, spanSize);
+                begin += spanSize;
+            }
+        }
+
+        /**
+         * @brief Copy a range into flat memory.
+         * 
+         * @param begin First element of the range.
+         * @param end End of the range, clamped to size().
+         * @param destination Memory receiving element begin at its start.
+         */
+        void copy(size_t begin, size_t end, void* destination) const {
+            unsigned char* bytes = static_cast<unsigned char*>(destination);
+            forEachSpan(begin, end, [&](size_t first, const T* data, size_t spanSize) {
+                std::memcpy(bytes + (first - begin) * sizeof(T), data, spanSize * sizeof(T));
+            });
+        }
+};
+
+}
@@ -47,6 +47,7 @@
 #include <RaeptorCogs/Time.hpp>
 #include <RaeptorCogs/Random.hpp>
 #include <RaeptorCogs/Platform.hpp>
+#include <RaeptorCogs/Transform.hpp>
 #include <RaeptorCogs/Singleton.hpp>
 #include <functional>
 
@@ -248,6 +249,17 @@ namespace RaeptorCogs {
      */
     Singletons::Platform& Platform();
 
+    /**
+     * @brief Access the global TransformHierarchy singleton.
+     * 
+     * @return Reference to the TransformHierarchy holding the transforms of every TransformableGraphic2D.
+     * 
+     * @code{.cpp}
+     * RaeptorCogs::Transforms().update(); // Rebuild the dirty subtrees now rather than on first read
+     * @endcode
+     */
+    TransformHierarchy& Transforms();
+
     /**
      * @brief Access the global ResourceManager singleton for a specific resource type.
      * 
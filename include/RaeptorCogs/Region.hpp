@@ -43,7 +43,12 @@
 #include <vector>
 #include <stdexcept>
 #include <algorithm>
+#include <array>
 #include <cstdint>
+#include <unordered_map>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace RaeptorCogs { 
 
@@ -125,7 +130,7 @@ class RegionBuffer {
             // Merge with next
             auto mergeNext = it;
             ++mergeNext;
-            while (mergeNext != regions.end() && mergeNext->first <= it->second + 1) {
+            while (mergeNext != regions.end() && mergeNext->first <= it->second) {
                 it->second = std::max(it->second, mergeNext->second);
                 mergeNext = regions.erase(mergeNext);
             }
@@ -133,7 +138,7 @@ class RegionBuffer {
             // Merge with previous
             if (it != regions.begin()) {
                 auto prev = it - 1;
-                if (prev->second + 1 >= it->first) {
+                if (prev->second >= it->first) {
                     prev->second = std::max(prev->second, it->second);
                     regions.erase(it);
                 }
@@ -256,46 +261,426 @@ class RegionBuffer {
 };
 
 
+/**
+ * @brief Sort and merge a list of regions.
+ * 
+ * @param regions Regions in any order, replaced by the merged regions sorted by begin.
+ * @param maxGap Largest gap between two regions bridged by the merge.
+ * 
+ * @code{.cpp}
+ * std::vector<RaeptorCogs::Region> regions = {{40, 50}, {0, 10}, {12, 20}};
+ * RaeptorCogs::CoalesceRegions(regions, 2); // {{0, 20}, {40, 50}}
+ * @endcode
+ * 
+ * @note Runs in O(n log n) where pushing each region into a RegionBuffer is O(n^2).
+ */
+inline void CoalesceRegions(std::vector<Region>& regions, size_t maxGap = 0) {
+    if (regions.empty()) return;
+    std::sort(regions.begin(), regions.end());
+    size_t write = 0;
+    for (size_t read = 1; read < regions.size(); ++read) {
+        if (regions[read].first <= regions[write].second + maxGap) {
+            regions[write].second = std::max(regions[write].second, regions[read].second);
+        } else {
+            regions[++write] = regions[read];
+        }
+    }
+    regions.resize(write + 1);
+}
+
+/**
+ * @brief DirtyRegions class.
+ * 
+ * Collects the ranges of an array changed since its last upload and turns them into
+ * as few update calls as is worth it.
+ * 
+ * @code{.cpp}
+ * RaeptorCogs::DirtyRegions dirty;
+ * dirty.mark(10, 12);
+ * dirty.mark(90000, 90002);
+ * dirty.resolve(100000, 64, 0.5); // {{10, 12}, {90000, 90002}}
+ * @endcode
+ * 
+ * @note Marking is O(1); merging is deferred to resolve.
+ */
+class DirtyRegions {
+    private:
+
+        // ============================================================================
+        //                             PRIVATE MEMBERS
+        // ============================================================================
+
+        /**
+         * @brief Marked ranges, unsorted and possibly overlapping until resolved.
+         */
+        std::vector<Region> regions;
+
+        /**
+         * @brief First marked index.
+         */
+        size_t first = SIZE_MAX;
+
+        /**
+         * @brief One past the last marked index.
+         */
+        size_t last = 0;
+
+    public:
+
+        // ============================================================================
+        //                             PUBLIC METHODS
+        // ============================================================================
+
+        /**
+         * @brief Number of pending ranges past which they are folded into their bounds.
+         * 
+         * @note Bounds the memory used by arrays changed many times between two uploads.
+         */
+        static constexpr size_t REGION_LIMIT = 1024;
+
+        /**
+         * @brief Mark a range as changed.
+         * 
+         * @param begin First changed index.
+         * @param end One past the last changed index.
+         * 
+         * @note Ranges touching the last marked one extend it, so appends stay a single range.
+         */
+        void mark(size_t begin, size_t end) {
+            if (begin >= end) return;
+            first = std::min(first, begin);
+            last = std::max(last, end);
+            if (!regions.empty() && begin <= regions.back().second && end >= regions.back().first) {
+                regions.back().first = std::min(regions.back().first, begin);
+                regions.back().second = std::max(regions.back().second, end);
+            } else if (regions.size() >= REGION_LIMIT) {
+                regions.assign(1, {first, last});
+            } else {
+                regions.emplace_back(begin, end);
+            }
+        }
+
+        /**
+         * @brief Get the range covering every marked index.
+         * 
+         * @param size Current size of the array, the range is clipped to it.
+         * @return The covering range, {0, 0} if nothing was marked.
+         */
+        Region getBounds(size_t size) const {
+            size_t end = std::min(last, size);
+            if (first >= end) return {0, 0};
+            return {first, end};
+        }
+
+        /**
+         * @brief Merge the marked ranges into the ranges to upload.
+         * 
+         * @param size Current size of the array, ranges are clipped to it.
+         * @param maxGap Largest gap between two ranges worth uploading rather than an extra call.
+         * @param fullRatio Fraction of the array above which it is uploaded in full.
+         * @return Sorted, disjoint ranges, empty if nothing was marked.
+         */
+        const std::vector<Region>& resolve(size_t size, size_t maxGap, double fullRatio) {
+            for (auto& region : regions) region.second = std::min(region.second, size);
+            regions.erase(std::remove_if(regions.begin(), regions.end(), [](const Region& region) {
+                return region.first >= region.second;
+            }), regions.end());
+            CoalesceRegions(regions, maxGap);
+
+            size_t changed = 0;
+            for (const auto& region : regions) changed += region.second - region.first;
+            if (changed > 0 && static_cast<double>(changed) > static_cast<double>(size) * fullRatio) {
+                regions.assign(1, {0, size});
+            }
+            return regions;
+        }
+
+        /**
+         * @brief Forget every marked range.
+         */
+        void clear() {
+            regions.clear();
+            first = SIZE_MAX;
+            last = 0;
+        }
+
+        /**
+         * @brief Check if no range was marked.
+         * 
+         * @return true if nothing was marked, false otherwise.
+         */
+        bool empty() const {
+            return regions.empty();
+        }
+};
+
 /**
  * @brief RegionAllocator class.
  * 
- * Allocates and frees memory regions using an underlying RegionBuffer.
+ * Allocates and frees regions of an index space with a two-level segregated fit
+ * (TLSF) scheme: free regions are kept in lists per size class, found through two
+ * levels of bitmaps, and merged with their free neighbours when freed.
  * 
  * @code{.cpp}
  * RaeptorCogs::RegionAllocator allocator;
+ * allocator.free(0, 1024);                   // Make [0, 1024) available
  * size_t offset = allocator.allocate(256);
  * allocator.free(offset, offset + 256);
  * @endcode
  * 
- * @note RegionAllocator main goal is to save memory fragmentation by reusing freed regions.
+ * @note Allocation and free run in O(1), whatever the number of free regions.
+ *       Freed regions must not overlap regions that are already free.
  */
-class RegionAllocator : public RegionBuffer {
+class RegionAllocator {
 public:
-    
+
+    // ============================================================================
+    //                               PUBLIC CONSTANTS
+    // ============================================================================
+
+    /**
+     * @brief Bits of the size used to pick a list within a power of two.
+     */
+    static constexpr unsigned int SECOND_LEVEL_BITS = 4;
+
+    /**
+     * @brief Lists per power of two.
+     * 
+     * @note Sizes below this count each get their own list.
+     */
+    static constexpr unsigned int SECOND_LEVEL_COUNT = 1u << SECOND_LEVEL_BITS;
+
+    /**
+     * @brief Number of first level classes, enough for any size_t size.
+     */
+    static constexpr unsigned int FIRST_LEVEL_COUNT = 64;
+
+private:
+
+    // ============================================================================
+    //                               PRIVATE ATTRIBUTES
+    // ============================================================================
+
+    /**
+     * @brief Marks the end of a free list.
+     */
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    /**
+     * @brief Free region, linked into the list of its size class.
+     */
+    struct Block {
+        size_t begin;
+        size_t end;
+        uint32_t previous;
+        uint32_t next;
+    };
+
+    /**
+     * @brief Block storage.
+     * 
+     * @note Released blocks are recycled through unusedBlocks.
+     */
+    std::vector<Block> blocks;
+
+    /**
+     * @brief Indices of the released blocks.
+     */
+    std::vector<uint32_t> unusedBlocks;
+
+    /**
+     * @brief Free blocks by their begin, to merge with a region freed right before them.
+     */
+    std::unordered_map<size_t, uint32_t> blocksByBegin;
+
+    /**
+     * @brief Free blocks by their end, to merge with a region freed right after them.
+     */
+    std::unordered_map<size_t, uint32_t> blocksByEnd;
+
+    /**
+     * @brief Bit f set when a list of first level class f is not empty.
+     */
+    uint64_t firstLevelMap = 0;
+
+    /**
+     * @brief Bit s of entry f set when list (f, s) is not empty.
+     */
+    std::array<uint32_t, FIRST_LEVEL_COUNT> secondLevelMaps{};
+
+    /**
+     * @brief First block of each list.
+     */
+    std::array<std::array<uint32_t, SECOND_LEVEL_COUNT>, FIRST_LEVEL_COUNT> heads;
+
+    /**
+     * @brief Total size of the free regions.
+     */
+    size_t freeSize = 0;
+
+    // ============================================================================
+    //                               PRIVATE METHODS
+    // ============================================================================
+
+    static unsigned int LowestBit(uint64_t value) {
+    #if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<unsigned int>(index);
+    #else
+        return static_cast<unsigned int>(__builtin_ctzll(value));
+    #endif
+    }
+
+    static unsigned int HighestBit(uint64_t value) {
+    #if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<unsigned int>(index);
+    #else
+        return 63u - static_cast<unsigned int>(__builtin_clzll(value));
+    #endif
+    }
+
+    /**
+     * @brief Get the list holding free regions of a size.
+     * 
+     * @param size Region size, not zero.
+     * @param firstLevel Receives the first level class.
+     * @param secondLevel Receives the list within that class.
+     */
+    static void Mapping(size_t size, unsigned int& firstLevel, unsigned int& secondLevel) {
+        if (size < SECOND_LEVEL_COUNT) {
+            firstLevel = 0;
+            secondLevel = static_cast<unsigned int>(size);
+            return;
+        }
+        unsigned int log = HighestBit(size);
+        firstLevel = log - SECOND_LEVEL_BITS + 1;
+        secondLevel = static_cast<unsigned int>((size >> (log - SECOND_LEVEL_BITS)) ^ SECOND_LEVEL_COUNT);
+    }
+
+    /**
+     * @brief Link a free region into its list.
+     * 
+     * @param begin Beginning of the region.
+     * @param end End of the region.
+     */
+    void insertBlock(size_t begin, size_t end) {
+        uint32_t index;
+        if (!unusedBlocks.empty()) {
+            index = unusedBlocks.back();
+            unusedBlocks.pop_back();
+        } else {
+            index = static_cast<uint32_t>(blocks.size());
+            blocks.emplace_back();
+        }
+        unsigned int firstLevel, secondLevel;
+        Mapping(end - begin, firstLevel, secondLevel);
+        uint32_t& head = heads[firstLevel][secondLevel];
+        blocks[index] = Block{begin, end, NONE, head};
+        if (head != NONE) blocks[head].previous = index;
+        head = index;
+        firstLevelMap |= uint64_t{1} << firstLevel;
+        secondLevelMaps[firstLevel] |= 1u << secondLevel;
+        blocksByBegin[begin] = index;
+        blocksByEnd[end] = index;
+        freeSize += end - begin;
+    }
+
+    /**
+     * @brief Unlink a free block from its list and release it.
+     * 
+     * @param index Index of the block.
+     */
+    void removeBlock(uint32_t index) {
+        Block block = blocks[index];
+        unsigned int firstLevel, secondLevel;
+        Mapping(block.end - block.begin, firstLevel, secondLevel);
+        if (block.previous != NONE) {
+            blocks[block.previous].next = block.next;
+        } else {
+            heads[firstLevel][secondLevel] = block.next;
+            if (block.next == NONE) {
+                secondLevelMaps[firstLevel] &= ~(1u << secondLevel);
+                if (secondLevelMaps[firstLevel] == 0) firstLevelMap &= ~(uint64_t{1} << firstLevel);
+            }
+        }
+        if (block.next != NONE) blocks[block.next].previous = block.previous;
+        blocksByBegin.erase(block.begin);
+        blocksByEnd.erase(block.end);
+        unusedBlocks.push_back(index);
+        freeSize -= block.end - block.begin;
+    }
+
+    /**
+     * @brief Find a free block from the first non-empty list at or above a size.
+     * 
+     * @param size Region size, rounded up to a list boundary.
+     * @return Index of the block, or NONE.
+     */
+    uint32_t findBlock(size_t size) const {
+        unsigned int firstLevel, secondLevel;
+        Mapping(size, firstLevel, secondLevel);
+        uint32_t secondLevelMap = secondLevelMaps[firstLevel] & (~0u << secondLevel);
+        if (secondLevelMap == 0) {
+            uint64_t firstLevelMask = firstLevel + 1 < FIRST_LEVEL_COUNT ? (~uint64_t{0} << (firstLevel + 1)) : 0;
+            uint64_t firstLevelMapAbove = firstLevelMap & firstLevelMask;
+            if (firstLevelMapAbove == 0) return NONE;
+            firstLevel = LowestBit(firstLevelMapAbove);
+            secondLevelMap = secondLevelMaps[firstLevel];
+        }
+        return heads[firstLevel][LowestBit(secondLevelMap)];
+    }
+
+public:
+
     // ============================================================================
     //                               PUBLIC METHODS
     // ============================================================================
 
+    /**
+     * @brief Default constructor for RegionAllocator.
+     */
+    RegionAllocator() {
+        for (auto& lists : heads) lists.fill(NONE);
+    }
+
     /**
      * @brief Allocate a region of the specified size.
      * 
      * @param size The size of the region to allocate.
      * @return size_t The beginning offset of the allocated region, or SIZE_MAX if allocation failed.
      * 
-     * @note Allocates the first fitting region found.
+     * @note Takes a region from the first non-empty list whose sizes all fit, and
+     *       frees what is left of it. Only when there is none is the list of the
+     *       exact size searched. Returns SIZE_MAX for a zero size.
      */
     size_t allocate(size_t size) {
-        for (auto r : *this) {
-            size_t regionSize = r.second - r.first;
-
-            if (regionSize >= size) {
-                // Consume part of the region
-                size_t offset = r.first;
-                this->erase(r.first, r.first + size);
-                return offset;
+        if (size == 0 || size > freeSize) return SIZE_MAX;
+        // Round up to the next list boundary so any region of the list found fits
+        size_t rounded = size;
+        if (size >= SECOND_LEVEL_COUNT) {
+            rounded += (size_t{1} << (HighestBit(size) - SECOND_LEVEL_BITS)) - 1;
+            if (rounded < size) return SIZE_MAX;
+        }
+        uint32_t index = this->findBlock(rounded);
+        if (index == NONE) {
+            // The list of the exact size may still hold a region large enough
+            unsigned int firstLevel, secondLevel;
+            Mapping(size, firstLevel, secondLevel);
+            index = heads[firstLevel][secondLevel];
+            while (index != NONE && blocks[index].end - blocks[index].begin < size) {
+                index = blocks[index].next;
             }
+            if (index == NONE) return SIZE_MAX;
+        }
+        Block block = blocks[index];
+        this->removeBlock(index);
+        if (block.end - block.begin > size) {
+            this->insertBlock(block.begin + size, block.end);
         }
-        return SIZE_MAX; // no free region available
+        return block.begin;
     }
 
     /**
@@ -304,10 +689,76 @@ public:
      * @param begin The beginning of the region to free.
      * @param end The end of the region to free.
      * 
-     * @note Merges with existing regions automatically.
+     * @note Merges with the free regions right before and after it.
      */
     void free(size_t begin, size_t end) {
-        this->push(begin, end);
+        if (begin > end) std::swap(begin, end);
+        if (begin == end) return;
+        auto before = blocksByEnd.find(begin);
+        if (before != blocksByEnd.end()) {
+            begin = blocks[before->second].begin;
+            this->removeBlock(before->second);
+        }
+        auto after = blocksByBegin.find(end);
+        if (after != blocksByBegin.end()) {
+            end = blocks[after->second].end;
+            this->removeBlock(after->second);
+        }
+        this->insertBlock(begin, end);
+    }
+
+    /**
+     * @brief Remove the free region ending at the end of the space, if any.
+     * 
+     * @param end Current end of the space.
+     * @return New end of the space.
+     * 
+     * @note Lets the owner of the space shrink it.
+     */
+    size_t trim(size_t end) {
+        auto last = blocksByEnd.find(end);
+        if (last == blocksByEnd.end()) return end;
+        size_t begin = blocks[last->second].begin;
+        this->removeBlock(last->second);
+        return begin;
+    }
+
+    /**
+     * @brief Remove every free region.
+     */
+    void clear() {
+        blocks.clear();
+        unusedBlocks.clear();
+        blocksByBegin.clear();
+        blocksByEnd.clear();
+        firstLevelMap = 0;
+        secondLevelMaps.fill(0);
+        for (auto& lists : heads) lists.fill(NONE);
+        freeSize = 0;
+    }
+
+    /**
+     * @brief Check if no region is free.
+     * @return true if empty, false otherwise.
+     */
+    bool empty() const {
+        return freeSize == 0;
+    }
+
+    /**
+     * @brief Get the number of free regions.
+     * @return size_t The number of regions.
+     */
+    size_t size() const {
+        return blocksByBegin.size();
+    }
+
+    /**
+     * @brief Get the total size of the free regions.
+     * @return size_t The free size.
+     */
+    size_t getFreeSize() const {
+        return freeSize;
     }
 };
-}
\ No newline at end of file
+}
@@ -169,6 +169,21 @@ class Renderer {
          */
         void setRenderListID(int index);
 
+        /**
+         * @brief Bucket the current render list by z layer.
+         * 
+         * @param enabled Whether to bucket the render list.
+         * @param zRange Width of the z ranges sharing a bucket, 0 for one bucket per z value.
+         * 
+         * @code{.cpp}
+         * RaeptorCogs::Renderer().setRenderListBucketed(true); // Background, world, FX and UI layers
+         * @endcode
+         * @note Graphics of a bucket are drawn in program and texture order, whatever their z
+         *       within the range. Applies to the mask render list of the same ID too.
+         * @see GAPI::Common::RenderList::setBucketed
+         */
+        void setRenderListBucketed(bool enabled, float zRange = 0.0f);
+
         /**
          * @brief Add a graphic to the renderer.
          * 
@@ -0,0 +1,221 @@
+/** ********************************************************************************
+ * @section Sort_Overview Overview
+ * @file Sort.hpp
+ * @brief Integer key sorting utilities.
+ * @details
+ * Typical use cases:
+ * - Sorting large index buffers by a packed 64-bit key (render lists)
+ * *********************************************************************************
+ * @section Sort_Header Header
+ * <RaeptorCogs/Sort.hpp>
+ ***********************************************************************************
+ * @section Sort_Metadata Metadata
+ * @author Estorc
+ * @version v1.0
+ * @copyright Copyright (c) 2025 Estorc MIT License.
+ **********************************************************************************/
+/*                             This file is part of
+ *                                  RaeptorCogs
+ *                     (https://github.com/Estorc/RaeptorCogs)
+ ***********************************************************************************
+ * Copyright (c) 2025 Estorc.
+ * This file is licensed under the MIT License.
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ***********************************************************************************/
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace RaeptorCogs {
+
+/**
+ * @brief RadixSorter class.
+ *
+ * Least-significant-digit radix sort over 64-bit keys carrying a 32-bit payload.
+ *
+ * @code{.cpp}
+ * RaeptorCogs::RadixSorter sorter;
+ * std::vector<unsigned int> indices = {2, 0, 1};
+ * std::vector<uint64_t> keys = {30, 10, 20};
+ * sorter.sort(indices, [&keys](unsigned int i) { return keys[i]; }); // indices = {0, 1, 2}
+ * @endcode
+ *
+ * @note The sort is stable. Scratch buffers are kept between calls so that sorting
+ *       a list of similar size every frame does not allocate. Inputs of at least
+ *       getParallelThreshold() values are split across worker threads, with results
+ *       identical to the serial sort.
+ */
+class RadixSorter {
+    private:
+
+        // ============================================================================
+        //                               PRIVATE ATTRIBUTES
+        // ============================================================================
+
+        /**
+         * @brief Keys of the values being sorted.
+         */
+        std::vector<uint64_t> keys;
+
+        /**
+         * @brief Scratch buffer for keys.
+         *
+         * Used as the destination of odd scatter passes.
+         */
+        std::vector<uint64_t> keysScratch;
+
+        /**
+         * @brief Scratch buffer for values.
+         *
+         * Used as the destination of odd scatter passes.
+         */
+        std::vector<unsigned int> valuesScratch;
+
+        /**
+         * @brief Number of threads used for large inputs.
+         *
+         * @note 0 selects std::thread::hardware_concurrency().
+         */
+        unsigned int threadCount = 0;
+
+        /**
+         * @brief Minimum number of values for which the parallel path is used.
+         */
+        size_t parallelThreshold = PARALLEL_THRESHOLD;
+
+        // ============================================================================
+        //                               PRIVATE METHODS
+        // ============================================================================
+
+        /**
+         * @brief Sort the values using the previously filled keys.
+         *
+         * @param values Pointer to the values to sort, in place.
+         * @param count Number of values.
+         */
+        void sortPairs(unsigned int* values, size_t count);
+
+        /**
+         * @brief Sort the values using the previously filled keys on several threads.
+         *
+         * @param values Pointer to the values to sort, in place.
+         * @param count Number of values.
+         * @param threads Number of threads, including the calling thread.
+         *
+         * @note Each pass counts digits per chunk, derives per-chunk offsets and scatters
+         *       every chunk concurrently, which keeps the sort stable.
+         */
+        void sortPairsParallel(unsigned int* values, size_t count, unsigned int threads);
+
+    public:
+
+        // ============================================================================
+        //                               PUBLIC METHODS
+        // ============================================================================
+
+        /**
+         * @brief Number of bits consumed by each pass.
+         */
+        static constexpr unsigned int DIGIT_BITS = 8;
+
+        /**
+         * @brief Number of buckets per pass.
+         */
+        static constexpr unsigned int DIGIT_COUNT = 1u << DIGIT_BITS;
+
+        /**
+         * @brief Number of passes needed to sort a 64-bit key.
+         */
+        static constexpr unsigned int PASS_COUNT = 64 / DIGIT_BITS;
+
+        /**
+         * @brief Default minimum number of values for which the parallel path is used.
+         *
+         * @note Below this size thread startup and synchronization cost more than the sort.
+         */
+        static constexpr size_t PARALLEL_THRESHOLD = 1 << 17;
+
+        /**
+         * @brief Default constructor for RadixSorter.
+         */
+        RadixSorter() = default;
+
+        /**
+         * @brief Sort values by the key returned for each of them.
+         *
+         * @tparam KeyFunction Callable taking a value and returning its uint64_t key.
+         * @param values Values to sort in place.
+         * @param keyOf Key extraction function, called once per value.
+         *
+         * @note Passes on digits shared by every key are skipped.
+         */
+        template<typename KeyFunction>
+        void sort(std::vector<unsigned int>& values, KeyFunction&& keyOf) {
+            keys.resize(values.size());
+            for (size_t i = 0; i < values.size(); ++i) {
+                keys[i] = keyOf(values[i]);
+            }
+            this->sortPairs(values.data(), values.size());
+        }
+
+        /**
+         * @brief Sort values by precomputed keys.
+         *
+         * @param sortKeys Keys to sort, sorted in place alongside the values.
+         * @param values Values to sort in place, same size as sortKeys.
+         */
+        void sort(std::vector<uint64_t>& sortKeys, std::vector<unsigned int>& values);
+
+        /**
+         * @brief Set the number of threads used for large inputs.
+         *
+         * @param count Number of threads, 1 to always sort serially, 0 for the hardware concurrency.
+         *
+         * @note Ignored on Emscripten, where sorting is always serial.
+         */
+        void setThreadCount(unsigned int count);
+
+        /**
+         * @brief Get the number of threads used for large inputs.
+         *
+         * @return Number of threads, 0 meaning the hardware concurrency.
+         */
+        unsigned int getThreadCount() const;
+
+        /**
+         * @brief Set the minimum number of values for which the parallel path is used.
+         *
+         * @param threshold Minimum number of values.
+         */
+        void setParallelThreshold(size_t threshold);
+
+        /**
+         * @brief Get the minimum number of values for which the parallel path is used.
+         *
+         * @return Minimum number of values.
+         */
+        size_t getParallelThreshold() const;
+
+        /**
+         * @brief Release the scratch buffers.
+         */
+        void shrink();
+};
+
+}
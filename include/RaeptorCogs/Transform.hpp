@@ -0,0 +1,471 @@
+/** ********************************************************************************
+ * @section Transform_Overview Overview
+ * @file Transform.hpp
+ * @brief Flattened transform hierarchy.
+ * @details
+ * Typical use cases:
+ * - Storing the local components and global matrices of 2D transforms in contiguous arrays
+ * - Updating the dirty subtrees of a hierarchy in one parent-before-child pass
+ * *********************************************************************************
+ * @section Transform_Header Header
+ * <RaeptorCogs/Transform.hpp>
+ ***********************************************************************************
+ * @section Transform_Metadata Metadata
+ * @author Estorc
+ * @version v1.0
+ * @copyright Copyright (c) 2025 Estorc MIT License.
+ **********************************************************************************/
+/*                             This file is part of
+ *                                  RaeptorCogs
+ *                     (https://github.com/Estorc/RaeptorCogs)
+ ***********************************************************************************
+ * Copyright (c) 2025 Estorc.
+ * This file is licensed under the MIT License.
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ***********************************************************************************/
+
+
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <climits>
+
+namespace RaeptorCogs {
+
+/**
+ * @brief Local transform components.
+ * 
+ * Position, size, scale, rotation and anchor of a 2D transform, relative to its parent.
+ */
+struct TransformComponents {
+    /** Position in the parent space */
+    glm::vec2 position = glm::vec2(0.0f, 0.0f);
+    /** Width and height */
+    glm::vec2 size = glm::vec2(1.0f, 1.0f);
+    /** Scaling factors along x and y axes */
+    glm::vec2 scale = glm::vec2(1.0f, 1.0f);
+    /** Rotation angle in radians */
+    float rotation = 0.0f;
+    /** Pivot point, in units of the size */
+    glm::vec2 anchor = glm::vec2(0.0f, 0.0f);
+    /** Translation along z, added to the parent's */
+    float depth = 0.0f;
+};
+
+/**
+ * @brief Local transform components of many transforms, one array per field.
+ * 
+ * @note Lets ComposeLocalAffines load the same field of several transforms at once.
+ */
+struct TransformComponentArrays {
+    /** Positions in the parent space */
+    std::vector<float> positionX, positionY;
+    /** Widths and heights */
+    std::vector<float> sizeX, sizeY;
+    /** Scaling factors along x and y axes */
+    std::vector<float> scaleX, scaleY;
+    /** Rotation angles in radians */
+    std::vector<float> rotation;
+    /** Pivot points, in units of the size */
+    std::vector<float> anchorX, anchorY;
+    /** Translations along z */
+    std::vector<float> depth;
+
+    /**
+     * @brief Get the number of transforms.
+     * 
+     * @return Length of the arrays.
+     */
+    size_t size() const { return rotation.size(); }
+
+    /**
+     * @brief Append the components of a transform.
+     * 
+     * @param components Components to append.
+     */
+    void push(const TransformComponents& components);
+
+    /**
+     * @brief Set the components of a transform.
+     * 
+     * @param index Index in the arrays.
+     * @param components New components.
+     */
+    void set(size_t index, const TransformComponents& components);
+
+    /**
+     * @brief Get the components of a transform.
+     * 
+     * @param index Index in the arrays.
+     * @return Components at the index.
+     */
+    TransformComponents get(size_t index) const;
+};
+
+/**
+ * @brief 2D affine transform.
+ * 
+ * Maps (x, y, z) to (a x + c y + tx, b x + d y + ty, z + tz).
+ * 
+ * @note Holds the non trivial entries of a glm::mat4 m: a = m[0][0], b = m[0][1], c = m[1][0],
+ *       d = m[1][1], tx = m[3][0], ty = m[3][1] and tz = m[3][2].
+ */
+struct Affine2D {
+    /** First column of the linear part */
+    float a = 1.0f, b = 0.0f;
+    /** Second column of the linear part */
+    float c = 0.0f, d = 1.0f;
+    /** Translation */
+    float tx = 0.0f, ty = 0.0f, tz = 0.0f;
+};
+
+/**
+ * @brief Compose the local affine transform of a set of components.
+ * 
+ * @param components Local components of the transform.
+ * @return translate(position) * rotate(rotation) * scale(size) * scale(scale) * translate(-anchor),
+ *         translated by depth along z.
+ * 
+ * @note Multiplies in the order of the glm::translate, glm::rotate and glm::scale chain, so
+ *       the entries equal those of the glm matrix.
+ */
+Affine2D ComposeLocalAffine(const TransformComponents& components);
+
+/**
+ * @brief Compose the local affine transforms of a batch of transforms.
+ * 
+ * @param components Local components, one array per field.
+ * @param indices Ascending indices in the arrays to compose.
+ * @param count Number of indices.
+ * @param locals Output transforms, indexed like the arrays.
+ * 
+ * @note Composes 8 transforms at a time with AVX2, 4 with SSE2 and one at a time otherwise,
+ *       each one equal to what ComposeLocalAffine returns. Batches without rotation skip
+ *       the sine and cosine.
+ */
+void ComposeLocalAffines(const TransformComponentArrays& components, const uint32_t* indices, size_t count, Affine2D* locals);
+
+/**
+ * @brief Compose the global affine transform of a child.
+ * 
+ * @param parentGlobal Global transform of the parent.
+ * @param parentSize Size of the parent.
+ * @param parentAnchor Anchor of the parent.
+ * @param local Local transform of the child.
+ * @return parentGlobal * translate(parentAnchor) * scale(1 / parentSize) * local.
+ * 
+ * @note Children are placed relative to the anchor of their parent, its size left out.
+ */
+Affine2D ComposeChildAffine(const Affine2D& parentGlobal, const glm::vec2& parentSize, const glm::vec2& parentAnchor, const Affine2D& local);
+
+/**
+ * @brief Transform identifier.
+ * 
+ * Stable handle of a node in a TransformHierarchy.
+ */
+using TransformID = uint32_t;
+
+/**
+ * @brief TransformHierarchy class.
+ * 
+ * Keeps the local components and global transforms of a 2D hierarchy in contiguous arrays,
+ * parents before their children.
+ * 
+ * Typical use cases:
+ * - Updating large sprite hierarchies and deep UI trees in a single sweep per frame
+ * 
+ * @code{.cpp}
+ * RaeptorCogs::TransformHierarchy hierarchy;
+ * RaeptorCogs::TransformID root = hierarchy.create();
+ * RaeptorCogs::TransformID child = hierarchy.create();
+ * hierarchy.setParent(child, root);
+ * hierarchy.setPosition(root, glm::vec2(10.0f, 0.0f));
+ * const RaeptorCogs::Affine2D& global = hierarchy.getGlobal(child); // Updates both
+ * @endcode
+ * @note Slots only move when a reparenting breaks the parent-before-child order, the
+ *       hierarchy then sorts them by depth on its next update.
+ */
+class TransformHierarchy {
+    private:
+
+        // ============================================================================
+        //                               PRIVATE ATTRIBUTES
+        // ============================================================================
+
+        /**
+         * @brief Local components, by slot.
+         */
+        TransformComponentArrays components;
+
+        /**
+         * @brief Local transforms, by slot.
+         * 
+         * @note Rebuilt from the components of dirty slots only.
+         */
+        std::vector<Affine2D> locals;
+
+        /**
+         * @brief Dirty slots of the current update, in ascending order.
+         * 
+         * @note Kept between updates to reuse its capacity.
+         */
+        std::vector<uint32_t> dirtySlots;
+
+        /**
+         * @brief Global transforms, by slot.
+         */
+        std::vector<Affine2D> globals;
+
+        /**
+         * @brief Slot of the parent of each slot, NO_SLOT for roots.
+         */
+        std::vector<uint32_t> parents;
+
+        /**
+         * @brief Dirty flags, by slot.
+         * 
+         * @note Set when the components or the parent of a slot changed.
+         */
+        std::vector<uint8_t> dirty;
+
+        /**
+         * @brief Update pass that last rebuilt the global transform of each slot.
+         * 
+         * @note Children of a slot stamped with the current pass are rebuilt too.
+         */
+        std::vector<uint32_t> stamps;
+
+        /**
+         * @brief Transform owning each slot, NO_TRANSFORM for free slots.
+         */
+        std::vector<TransformID> owners;
+
+        /**
+         * @brief Slot of each transform, NO_SLOT for destroyed transforms.
+         */
+        std::vector<uint32_t> slots;
+
+        /**
+         * @brief Destroyed transforms, reused by create.
+         */
+        std::vector<TransformID> freeTransforms;
+
+        /**
+         * @brief Slots left by destroyed transforms, reused by create.
+         */
+        std::vector<uint32_t> freeSlots;
+
+        /**
+         * @brief Lowest dirty slot, SIZE_MAX if none.
+         * 
+         * @note The update pass starts there.
+         */
+        size_t firstDirty = SIZE_MAX;
+
+        /**
+         * @brief Current update pass.
+         */
+        uint32_t pass = 0;
+
+        /**
+         * @brief Whether a reparenting put a child before its parent.
+         */
+        bool orderDirty = false;
+
+        // ============================================================================
+        //                               PRIVATE METHODS
+        // ============================================================================
+
+        /**
+         * @brief Mark a slot dirty.
+         * 
+         * @param slot Slot to mark.
+         */
+        void markSlotDirty(uint32_t slot);
+
+        /**
+         * @brief Sort the slots by depth, dropping the free ones.
+         * 
+         * @note Stable, so siblings keep their relative order.
+         */
+        void sortSlots();
+
+    public:
+
+        // ============================================================================
+        //                               PUBLIC METHODS
+        // ============================================================================
+
+        /**
+         * @brief Slot of a root's parent, or of a destroyed transform.
+         */
+        static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+        /**
+         * @brief Identifier of no transform.
+         */
+        static constexpr TransformID NO_TRANSFORM = UINT32_MAX;
+
+        /**
+         * @brief Create a root transform with default components.
+         * 
+         * @return Identifier of the transform.
+         */
+        TransformID create();
+
+        /**
+         * @brief Destroy a transform.
+         * 
+         * @param id Identifier of the transform.
+         * 
+         * @note Its children must have been detached first.
+         */
+        void destroy(TransformID id);
+
+        /**
+         * @brief Set the parent of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @param parent Identifier of the new parent, NO_TRANSFORM to make it a root.
+         */
+        void setParent(TransformID id, TransformID parent);
+
+        /**
+         * @brief Get the parent of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @return Identifier of the parent, NO_TRANSFORM for roots.
+         */
+        TransformID getParent(TransformID id) const;
+
+        /**
+         * @brief Get the local components of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @return Copy of the components.
+         */
+        TransformComponents getComponents(TransformID id) const { return components.get(slots[id]); }
+
+        /**
+         * @brief Set the local components of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @param components New components.
+         */
+        void setComponents(TransformID id, const TransformComponents& components);
+
+        /**
+         * @brief Set the position of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @param position New position in the parent space.
+         */
+        void setPosition(TransformID id, const glm::vec2& position);
+
+        /**
+         * @brief Set the size of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @param size New width and height.
+         */
+        void setSize(TransformID id, const glm::vec2& size);
+
+        /**
+         * @brief Set the scale of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @param scale New scaling factors.
+         */
+        void setScale(TransformID id, const glm::vec2& scale);
+
+        /**
+         * @brief Set the rotation of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @param rotation New rotation angle in radians.
+         */
+        void setRotation(TransformID id, float rotation);
+
+        /**
+         * @brief Set the anchor of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @param anchor New pivot point, in units of the size.
+         */
+        void setAnchor(TransformID id, const glm::vec2& anchor);
+
+        /**
+         * @brief Set the depth of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @param depth New translation along z.
+         */
+        void setDepth(TransformID id, float depth);
+
+        /**
+         * @brief Mark a transform for rebuilding.
+         * 
+         * @param id Identifier of the transform.
+         * 
+         * @note The setters already do.
+         */
+        void markDirty(TransformID id);
+
+        /**
+         * @brief Check if an update is pending.
+         * 
+         * @return true if a transform changed since the last update, false otherwise.
+         */
+        bool needsUpdate() const { return firstDirty != SIZE_MAX || orderDirty; }
+
+        /**
+         * @brief Rebuild the global transforms of the dirty subtrees.
+         * 
+         * @note The local transforms of the dirty slots are composed in batches first, then
+         *       one pass from the lowest dirty slot rebuilds the global ones; slots are visited
+         *       parents first, so a child is rebuilt right after any ancestor it depends on.
+         */
+        void update();
+
+        /**
+         * @brief Get the global transform of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @return Const reference to the global transform, valid until the next update.
+         * 
+         * @note Updates the hierarchy first if needed.
+         */
+        const Affine2D& getGlobal(TransformID id);
+
+        /**
+         * @brief Get the slot of a transform.
+         * 
+         * @param id Identifier of the transform.
+         * @return Slot in the arrays, NO_SLOT for destroyed transforms.
+         */
+        uint32_t getSlot(TransformID id) const { return id < slots.size() ? slots[id] : NO_SLOT; }
+
+        /**
+         * @brief Get the number of slots, free ones included.
+         * 
+         * @return Size of the arrays.
+         */
+        size_t size() const { return components.size(); }
+};
+
+}
@@ -56,11 +56,23 @@ def preprocess_shader(file_path, included_files=None, base_dir=None, system_incl
             content += line + "\n"
     return content
 
+def inject_defines(content, defines):
+    # Defines must follow the #version directive, which has to stay the first line
+    if not defines:
+        return content
+    define_lines = "".join(f"#define {define}\n" for define in defines)
+    lines = content.splitlines(keepends=True)
+    for index, line in enumerate(lines):
+        if line.strip().startswith("#version"):
+            return "".join(lines[:index + 1]) + define_lines + "".join(lines[index + 1:])
+    return define_lines + content
+
 def main():
     out_path = Path(sys.argv[1])
     
     # Check if system include dirs are provided
     system_include_dirs = []
+    defines = []
     remaining_args = []
     
     i = 2
@@ -68,6 +80,9 @@ def main():
         if sys.argv[i] == "-I" and i + 1 < len(sys.argv):
             system_include_dirs.append(sys.argv[i+1])
             i += 2
+        elif sys.argv[i] == "-D" and i + 1 < len(sys.argv):
+            defines.append(sys.argv[i+1])
+            i += 2
         else:
             remaining_args.append(sys.argv[i])
             i += 1
@@ -81,6 +96,7 @@ def main():
         for shader_path in shader_files:
             var_name = shader_path.name.replace('.', '_')
             processed = preprocess_shader(shader_path, system_include_dirs=system_include_dirs)
+            processed = inject_defines(processed, defines)
             out_file.write(f'static const char* __shader__{var_name} = R"({processed})";\n\n')
 
 if __name__ == "__main__":
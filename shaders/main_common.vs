@@ -1,6 +1,17 @@
 layout(location = 0) in vec2 vertexPos;
 layout(location = 1) in vec2 vertexUV;
 
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+struct InstanceGPUData { // Static SSBO structure, 48 bytes
+    vec4 linear; // 2x2 part of the model matrix, column major
+    vec2 translation;
+    float z;
+    uint color; // RGBA8
+    uvec2 uv; // unorm16 x/y, then w/h
+    uint typeAndMasks; // type (8 bits), read mask ID (12 bits), write mask ID (12 bits)
+    int dataOffset;
+};
+#else
 struct InstanceGPUData { // Static SSBO structure
     mat4 model;
     vec4 uv;
@@ -9,6 +20,7 @@ struct InstanceGPUData { // Static SSBO structure
     int writeMaskID;
     int readMaskID;
 };
+#endif
 
 layout(std430, binding = 0) readonly buffer IndirectionBuffer {
     int instanceIndices[];
@@ -25,6 +37,9 @@ flat out int Type; // Instance type
 flat out int DataOffset; // Offset into another SSBO or same buffer
 flat out int readMaskID; // Reading mask ID
 flat out int writeMaskID; // Writing mask ID
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+flat out vec4 vColor; // Instance color
+#endif
 
 uniform mat4 uViewMatrix;
 uniform mat4 uProjectionMatrix;
@@ -32,18 +47,31 @@ uniform float uTime;
 
 void main() {
     InstanceGPUData instance = instances[instanceIndices[gl_InstanceID + gl_BaseInstance]];
-    if (instance.type == 0) {
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+    int type = int(instance.typeAndMasks & 0xFFu);
+    mat4 model = mat4(
+        vec4(instance.linear.xy, 0.0, 0.0),
+        vec4(instance.linear.zw, 0.0, 0.0),
+        vec4(0.0, 0.0, 1.0, 0.0),
+        vec4(instance.translation, instance.z, 1.0));
+    vec4 uv = vec4(unpackUnorm2x16(instance.uv.x), unpackUnorm2x16(instance.uv.y));
+#else
+    int type = instance.type;
+    mat4 model = instance.model;
+    vec4 uv = instance.uv;
+#endif
+    if (type == 0) {
         gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
         return;
     }
 
-    vClipPos = uProjectionMatrix * uViewMatrix * instance.model * vec4(vertexPos, 0.0, 1.0);
+    vClipPos = uProjectionMatrix * uViewMatrix * model * vec4(vertexPos, 0.0, 1.0);
     gl_Position = vClipPos; // Slight animation for testing
     //gl_Position.xy += sin(uTime + float(gl_InstanceID)) * 0.01;
-    Type = instance.type;
+    Type = type;
 
     // UV coordinates
-    vUV = instance.uv.xy + vertexUV * instance.uv.zw;
+    vUV = uv.xy + vertexUV * uv.zw;
 
     // Assign barycentric coordinates
     /*if (vertexID == 0) vBarycentric = vec3(1,0,0);
@@ -52,6 +80,13 @@ void main() {
     vBarycentric = vec3(1.0); // Not used for now
 
     DataOffset = instance.dataOffset;
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+    readMaskID = int((instance.typeAndMasks >> 8) & 0xFFFu);
+    writeMaskID = int(instance.typeAndMasks >> 20);
+    uvec4 channels = (uvec4(instance.color) >> uvec4(0u, 8u, 16u, 24u)) & 0xFFu;
+    vColor = vec4(channels) / 255.0;
+#else
     readMaskID = instance.readMaskID;
     writeMaskID = instance.writeMaskID;
+#endif
 }
\ No newline at end of file
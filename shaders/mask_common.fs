@@ -5,6 +5,9 @@ flat in int readMaskID;
 in vec2 vUV;
 in vec3 vBarycentric;
 in vec4 vClipPos;
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+flat in vec4 vColor;
+#endif
 out uvec4 FragMask;
 
 uniform sampler2D uTextureSampler;
@@ -26,13 +29,22 @@ void main() {
     switch (Type) {
         case RENDERER_MODE_2D_SPRITE:
             // Default rendering behavior
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+            fillColor.rgb = vColor.rgb;
+#else
             fillColor.rgb = unpackVec3(DataOffset);
+#endif
             fillColor = texture(uTextureSampler, vUV) * vec4(fillColor.rgb, 1.0);
             break;
         case RENDERER_MODE_2D_TEXT:
             // Custom rendering behavior for mode 2
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+            fillColor.rgb = vColor.rgb;
+            float smoothing = unpackFloat(DataOffset);
+#else
             fillColor.rgb = unpackVec3(DataOffset);
             float smoothing = unpackFloat(DataOffset + 3);
+#endif
             float dist = texture(uTextureSampler, vUV).r; // 0..1
             // Map distance around 0.5 = glyph edge
             float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, dist);
@@ -1,6 +1,7 @@
 #include <RaeptorCogs/GAPI/Common/Core/InstanceData.hpp>
 #include <RaeptorCogs/GAPI/Common/RendererBackend.hpp>
 #include <RaeptorCogs/External/glad/glad.hpp>
+#include <stdexcept>
 
 namespace RaeptorCogs::GAPI::Common {
 
@@ -14,9 +15,20 @@ size_t InstanceAllocator::allocateStaticData() {
 }
 
 size_t InstanceAllocator::allocateDynamicData(size_t size) {
+    if (size == 0) return 0; // Graphics whose data fits in the static instance
+    // Writers get a raw pointer, so an allocation must stay within one page
     size_t offset = freeDynamicDataRegionsAllocator.allocate(size);
+    if (offset != SIZE_MAX && DynamicInstanceDataBuffer::crossesPage(offset, size)) {
+        freeDynamicDataRegionsAllocator.free(offset, offset + size);
+        offset = SIZE_MAX;
+    }
     if (offset == SIZE_MAX) {
         offset = instanceData.getDynamic().size();
+        if (DynamicInstanceDataBuffer::crossesPage(offset, size)) {
+            size_t pageEnd = offset + DynamicInstanceDataBuffer::PAGE_SIZE - offset % DynamicInstanceDataBuffer::PAGE_SIZE;
+            freeDynamicDataRegionsAllocator.free(offset, pageEnd);
+            offset = pageEnd;
+        }
         instanceData.getDynamic().resize(offset + size);
     }
     return offset;
@@ -33,12 +45,58 @@ void InstanceAllocator::freeStaticData(size_t begin, size_t end) {
 }
 
 void InstanceAllocator::freeDynamicData(size_t begin, size_t end) {
+    if (begin == end) return;
     freeDynamicDataRegionsAllocator.free(begin, end);
 }
 
 void InstanceAllocator::free(GraphicBatchHandler& batchHandler) {
     this->freeStaticData(batchHandler.staticDataCursor, batchHandler.staticDataCursor + 1);
     this->freeDynamicData(batchHandler.dynamicDataCursor, batchHandler.dynamicDataCursor + batchHandler.dynamicDataSize);
+    batchHandler.dynamicDataSize = 0; // Nothing left for the defragmenter to move
+}
+
+bool InstanceAllocator::moveStaticDataFront(GraphicBatchHandler& batchHandler) {
+    size_t offset = freeStaticDataRegionsAllocator.allocate(1);
+    if (offset == SIZE_MAX) return false;
+    if (offset > batchHandler.staticDataCursor) {
+        freeStaticDataRegionsAllocator.free(offset, offset + 1);
+        return false;
+    }
+    auto& staticData = instanceData.getStatic();
+    staticData[offset] = staticData[batchHandler.staticDataCursor];
+    this->freeStaticData(batchHandler.staticDataCursor, batchHandler.staticDataCursor + 1);
+    batchHandler.staticDataCursor = static_cast<unsigned int>(offset);
+    return true;
+}
+
+bool InstanceAllocator::moveDynamicDataFront(GraphicBatchHandler& batchHandler) {
+    size_t size = batchHandler.dynamicDataSize;
+    if (size == 0) return false;
+    size_t offset = freeDynamicDataRegionsAllocator.allocate(size);
+    if (offset == SIZE_MAX) return false;
+    if (offset > batchHandler.dynamicDataCursor || DynamicInstanceDataBuffer::crossesPage(offset, size)) {
+        freeDynamicDataRegionsAllocator.free(offset, offset + size);
+        return false;
+    }
+    auto& dynamicData = instanceData.getDynamic();
+    for (size_t i = 0; i < size; ++i) {
+        dynamicData[offset + i] = dynamicData[batchHandler.dynamicDataCursor + i];
+    }
+    this->freeDynamicData(batchHandler.dynamicDataCursor, batchHandler.dynamicDataCursor + size);
+    batchHandler.dynamicDataCursor = static_cast<unsigned int>(offset);
+    instanceData.getStatic()[batchHandler.staticDataCursor].dataOffset = batchHandler.dynamicDataCursor;
+    return true;
+}
+
+void InstanceAllocator::trim() {
+    auto trimTail = [](RegionAllocator& allocator, auto& data) {
+        size_t end = allocator.trim(data.size());
+        if (end == data.size()) return;
+        data.resize(end);
+        data.shrinkToFit();
+    };
+    trimTail(freeStaticDataRegionsAllocator, instanceData.getStatic());
+    trimTail(freeDynamicDataRegionsAllocator, instanceData.getDynamic());
 }
 
 StaticInstanceData& InstanceAllocator::getStaticInstanceData(size_t offset) {
@@ -51,27 +109,109 @@ DynamicInstanceData* InstanceAllocator::getDynamicInstanceData(size_t offset) {
 
 
 void InstanceUploader::markDynamicDataDirty(size_t offset, size_t size) {
-    dirtyDynamicDataRegions.push(offset, offset + size);
+    if (size == 0) return;
+    dirtyDynamicDataRegions.emplace_back(offset, offset + size);
 }
 
 void InstanceUploader::markStaticDataDirty(size_t offset, size_t size) {
-    dirtyStaticDataRegions.push(offset, offset + size);
+    dirtyStaticDataRegions.emplace_back(offset, offset + size);
 }
 
-void InstanceUploader::upload(ObjectHandler<SSBO>* staticInstanceDataSSBO, ObjectHandler<SSBO>* dynamicInstanceDataSSBO) {
-    for (const auto& region : this->dirtyStaticDataRegions) {
-        size_t begin = region.first;
-        size_t end = region.second;
+size_t InstanceUploader::GetBufferCapacity(size_t capacity, size_t size) {
+    if (capacity < MIN_BUFFER_CAPACITY) capacity = MIN_BUFFER_CAPACITY;
+    while (capacity < size) capacity *= 2;
+    while (capacity > MIN_BUFFER_CAPACITY && size < capacity / 4) capacity /= 2;
+    return capacity;
+}
+
+#ifndef __EMSCRIPTEN__
+bool InstanceUploader::fitBuffer(ObjectHandler<SSBO>* ssbo, size_t& capacity, size_t size, size_t elementSize) {
+    size_t fitted = GetBufferCapacity(capacity, size);
+    if (fitted == capacity) return false;
+
+    RaeptorCogs::GAPI::ObjectHandler<SSBO> resized;
+    resized->bind();
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(fitted * elementSize), nullptr, GL_DYNAMIC_DRAW);
+
+    // Live data sits in front after defragmentation, anything past the size is dropped
+    size_t kept = std::min({capacity, fitted, size});
+    if (kept > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, (*ssbo)->getID());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, resized->getID());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(kept * elementSize));
+    }
+    std::swap(*ssbo, resized);
+    capacity = fitted;
+    return true;
+}
+#endif
+
+UploadStats InstanceUploader::upload(ObjectHandler<SSBO>* staticInstanceDataSSBO, ObjectHandler<SSBO>* dynamicInstanceDataSSBO) {
+    UploadStats stats;
+    // Bridge gaps cheaper to send than an extra call, dense changes end up as a single full range
+    CoalesceRegions(this->dirtyStaticDataRegions, UPLOAD_CALL_COST / sizeof(Common::StaticInstanceData));
+    CoalesceRegions(this->dirtyDynamicDataRegions, UPLOAD_CALL_COST / sizeof(Common::DynamicInstanceData));
+
+    #ifndef __EMSCRIPTEN__
+    if (this->mode == InstanceUploadMode::PERSISTENT_RING) {
+        auto toBytes = [](std::vector<Region>& regions, size_t elementSize) -> std::vector<Region>& {
+            for (auto& region : regions) {
+                region.first *= elementSize;
+                region.second *= elementSize;
+            }
+            return regions;
+        };
+        auto& staticData = this->instanceData.getStatic();
+        auto& dynamicData = this->instanceData.getDynamic();
+        stats += this->staticDataRing.write(toBytes(this->dirtyStaticDataRegions, sizeof(Common::StaticInstanceData)), staticData.size() * sizeof(Common::StaticInstanceData),
+            [&staticData](size_t begin, size_t end, unsigned char* destination) {
+                staticData.copy(begin / sizeof(Common::StaticInstanceData), end / sizeof(Common::StaticInstanceData), destination);
+            });
+        stats += this->dynamicDataRing.write(toBytes(this->dirtyDynamicDataRegions, sizeof(Common::DynamicInstanceData)), dynamicData.size() * sizeof(Common::DynamicInstanceData),
+            [&dynamicData](size_t begin, size_t end, unsigned char* destination) {
+                dynamicData.copy(begin / sizeof(Common::DynamicInstanceData), end / sizeof(Common::DynamicInstanceData), destination);
+            });
+        // The slice moves when a write follows draws, so bind even when nothing was written
+        this->staticDataRing.bind(1);
+        this->dynamicDataRing.bind(2);
+        this->dirtyStaticDataRegions.clear();
+        this->dirtyDynamicDataRegions.clear();
+        return stats;
+    }
+    // Grows with the instances and shrinks once defragmentation trimmed them
+    this->bindingsOutdated |= this->fitBuffer(staticInstanceDataSSBO, this->staticBufferCapacity, this->instanceData.getStatic().size(), sizeof(Common::StaticInstanceData));
+    this->bindingsOutdated |= this->fitBuffer(dynamicInstanceDataSSBO, this->dynamicBufferCapacity, this->instanceData.getDynamic().size(), sizeof(Common::DynamicInstanceData));
+    if (this->bindingsOutdated) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, staticInstanceDataSSBO->get()->getID());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, dynamicInstanceDataSSBO->get()->getID());
+        this->bindingsOutdated = false;
+    }
+    #endif
+
+    if (!this->dirtyStaticDataRegions.empty()) {
         staticInstanceDataSSBO->get()->bind();
-        glBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(begin * sizeof(Common::StaticInstanceData)), static_cast<GLsizeiptr>((end - begin) * sizeof(Common::StaticInstanceData)), this->instanceData.getStatic().data() + begin);
+    }
+    // One update per page covered, pages map to consecutive ranges of the SSBO
+    for (const auto& region : this->dirtyStaticDataRegions) {
+        this->instanceData.getStatic().forEachSpan(region.first, region.second, [&stats](size_t first, const Common::StaticInstanceData* data, size_t count) {
+            stats.uploadCount++;
+            stats.uploadedBytes += count * sizeof(Common::StaticInstanceData);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(first * sizeof(Common::StaticInstanceData)), static_cast<GLsizeiptr>(count * sizeof(Common::StaticInstanceData)), data);
+        });
     }
     for (const auto& region : this->dirtyDynamicDataRegions) {
         size_t begin = region.first;
         size_t end = region.second;
         #ifndef __EMSCRIPTEN__
         dynamicInstanceDataSSBO->get()->bind();
-        glBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(begin * sizeof(Common::DynamicInstanceData)), static_cast<GLsizeiptr>((end - begin) * sizeof(Common::DynamicInstanceData)), this->instanceData.getDynamic().data() + begin);
+        this->instanceData.getDynamic().forEachSpan(begin, end, [&stats](size_t first, const Common::DynamicInstanceData* data, size_t count) {
+            stats.uploadCount++;
+            stats.uploadedBytes += count * sizeof(Common::DynamicInstanceData);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(first * sizeof(Common::DynamicInstanceData)), static_cast<GLsizeiptr>(count * sizeof(Common::DynamicInstanceData)), data);
+        });
         #else
+        stats.uploadCount++;
+        stats.uploadedBytes += (end - begin) * sizeof(Common::DynamicInstanceData);
         glActiveTexture(GL_TEXTURE0 + this->getMaxTextureUnits() - 1);
         this->iDataTex->bind();
         size_t dataOffset = begin - begin % 4; // Align to 4 floats
@@ -96,5 +236,25 @@ void InstanceUploader::upload(ObjectHandler<SSBO>* staticInstanceDataSSBO, Objec
     }
     this->dirtyDynamicDataRegions.clear();
     this->dirtyStaticDataRegions.clear();
+    return stats;
+}
+
+void InstanceUploader::setUploadMode(InstanceUploadMode mode) {
+    if (mode == this->mode) return;
+    if (mode == InstanceUploadMode::PERSISTENT_RING) {
+        #ifdef __EMSCRIPTEN__
+        throw std::runtime_error("Persistent ring uploads are not available on Emscripten.");
+        #else
+        if (!GLAD_GL_VERSION_4_4) {
+            throw std::runtime_error("Persistent ring uploads require OpenGL 4.4.");
+        }
+        #endif
+    }
+    this->mode = mode;
+    // The buffers of the new mode missed every change made through the previous one
+    this->markStaticDataDirty(0, this->instanceData.getStatic().size());
+    this->markDynamicDataDirty(0, this->instanceData.getDynamic().size());
+    this->bindingsOutdated = true;
+}
+
 }
-}
\ No newline at end of file
@@ -7,9 +7,13 @@ namespace RaeptorCogs::GAPI::Common {
 void GraphicCore::updateGraphicGPUData() {
     RenderPipeline& pipeline = this->getRenderer().getRenderPipeline();
     if (pipeline.getRenderList().wasReordered()) {
+        for (auto [first, last] : pipeline.getRenderList().getUploadRegions()) {
+            this->uploadStats.uploadCount++;
+            this->uploadStats.uploadedBytes += (last - first) * sizeof(unsigned int);
+        }
         pipeline.getRenderList().uploadOrderIndices();
     }
-    this->getInstanceUploader().upload(&this->staticInstanceDataSSBO, &this->dynamicInstanceDataSSBO);
+    this->uploadStats += this->getInstanceUploader().upload(&this->staticInstanceDataSSBO, &this->dynamicInstanceDataSSBO);
 }
 
 ObjectHandler<Common::SSBO>& GraphicCore::getStaticInstanceDataSSBO() {
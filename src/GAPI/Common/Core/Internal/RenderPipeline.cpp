@@ -16,6 +16,14 @@ GraphicBatchHandler &RenderPipeline::getBatchHandlerAt(size_t index) {
     return this->getRenderList().getHandler(index);
 }
 
+BatchKey &RenderPipeline::getBatchKeyAt(size_t index) {
+    return this->batch.getKey(index);
+}
+
+uint32_t RenderPipeline::getTextureSlot(uint32_t textureID) {
+    return this->textureSlots.get(textureID);
+}
+
 void RenderPipeline::setRenderListID(int index) {
     if (index < 0 || index == static_cast<int>(PrivateRenderListID::DRAW)) {
         throw std::runtime_error("The Render List " + std::to_string(index) + " is reserved for internal use.");
@@ -47,12 +55,21 @@ void RenderPipeline::clearRenderLists() {
         pair.second.clear();
     }
     this->renderLists.clear();
+    this->dirtyHandlers.clear();
 }
 
-bool RenderPipeline::compatibleBatches(Common::GraphicBatchHandler* a, Common::GraphicBatchHandler* b) {
-    return (a->rendererKey.textureID == b->rendererKey.textureID) &&
-           ((a->rendererKey.writingMask && a->rendererKey.readingMask == b->rendererKey.readingMask) ||
-            (a->rendererKey.writingMask == 0 && b->rendererKey.writingMask == 0));
+void RenderPipeline::compactRenderLists() {
+    for (auto& pair : this->renderLists) {
+        if (pair.second.needsCompaction()) pair.second.compact();
+    }
+}
+
+bool RenderPipeline::compatibleBatches(const BatchKey& a, const BatchKey& b) {
+    // Mask writers batch with anything reading the same mask, other graphics only with non-writers
+    uint64_t fields = a.isWriting()
+        ? BatchKey::TEXTURE_FIELD | BatchKey::READING_MASK_FIELD
+        : BatchKey::TEXTURE_FIELD | BatchKey::WRITING_FIELD;
+    return a.matches(b, fields);
 }
 
 void RenderPipeline::beginBatch(int x, int y, int width, int height, ObjectHandler<Common::Shader>& shader) {
@@ -95,57 +112,145 @@ void RenderPipeline::beginBatch(int x, int y, int width, int height, ObjectHandl
     #ifdef __EMSCRIPTEN__
     this->getRenderer().getGraphicCore().setSSBOTextureUniform(shader);
     #endif
+    this->boundTextureSlot = UINT32_MAX;
 }
 
-void RenderPipeline::drawBatch(Common::GraphicBatchHandler* firstHandler, size_t instanceOffset, size_t instanceCount, std::function<void()> postDrawCallback) {
+void RenderPipeline::drawBatch(const DrawCommand& command, std::function<void()> postDrawCallback) {
 
     // Bind texture
-    this->getRenderer().getGraphicCore().bindGraphicTexture(*firstHandler->graphic);
+    if (command.textureSlot != this->boundTextureSlot) {
+        this->getRenderer().getGraphicCore().bindGraphicTexture(*this->batch[command.handlerIndex].graphic);
+        this->boundTextureSlot = command.textureSlot;
+    }
 
-    
-    if (firstHandler->graphic->getWritingMaskID()) {
+    if (command.writing) {
         this->getRenderer().getGraphicCore().enableStencilGuarding();
     }
 
     // Draw the quad
-    unsigned int baseInstance = static_cast<unsigned int>(instanceOffset);
-    this->getRenderer().getGraphicCore().drawElementsInstancedBaseVertexBaseInstance(6, instanceCount, 0, 0, baseInstance);
+    this->getRenderer().getGraphicCore().drawElementsInstancedBaseVertexBaseInstance(6, command.instanceCount, 0, 0, command.baseInstance);
     if (postDrawCallback) postDrawCallback();
 }
 
+void RenderPipeline::relocateHandler(size_t from, size_t to) {
+    this->batch.move(from, to);
+    GraphicBatchHandler& handler = this->batch[to];
+    handler.graphic->setBatchHandlerCursor(to);
+    for (RenderList* renderList : handler.graphic->getRenderLists()) {
+        renderList->relocate(static_cast<unsigned int>(from), static_cast<unsigned int>(to));
+    }
+    if (handler.isDirty) {
+        this->dirtyHandlers.push_back(to);
+    }
+    this->batch[from].isDirty = false;
+    this->batch[from].dynamicDataSize = 0;
+}
+
+void RenderPipeline::defragmentInstances(size_t byteBudget) {
+    GraphicCore& graphicCore = this->getRenderer().getGraphicCore();
+    InstanceAllocator& allocator = graphicCore.getInstanceAllocator();
+    InstanceUploader& uploader = graphicCore.getInstanceUploader();
+    size_t spent = 0;
+
+    // Static data: batch indices follow the static cursors, so the handler moves along
+    allocator.trim();
+    while (spent < byteBudget && allocator.hasFreeStaticData() && allocator.getStaticDataSize() > 0) {
+        // Live, trim() dropped any free tail, so every free slot is further front
+        size_t from = allocator.getStaticDataSize() - 1;
+        GraphicBatchHandler& handler = this->batch[from];
+        if (!allocator.moveStaticDataFront(handler)) break;
+        size_t to = handler.staticDataCursor;
+        this->relocateHandler(from, to);
+        uploader.markStaticDataDirty(to, 1);
+        spent += sizeof(StaticInstanceData);
+        allocator.trim();
+    }
+    if (this->batch.size() > allocator.getStaticDataSize()) {
+        this->batch.truncate(allocator.getStaticDataSize());
+    }
+
+    // Dynamic data: round-robin sweep, a visit costs as much as a handler's worth of bytes
+    for (size_t visited = 0; visited < this->batch.size() && spent < byteBudget && allocator.hasFreeDynamicData(); ++visited) {
+        if (this->defragmentCursor >= this->batch.size()) this->defragmentCursor = 0;
+        GraphicBatchHandler& handler = this->batch[this->defragmentCursor++];
+        spent += sizeof(GraphicBatchHandler);
+        if (allocator.moveDynamicDataFront(handler)) {
+            uploader.markDynamicDataDirty(handler.dynamicDataCursor, handler.dynamicDataSize);
+            uploader.markStaticDataDirty(handler.staticDataCursor, 1);
+            spent += handler.dynamicDataSize * sizeof(DynamicInstanceData) + sizeof(StaticInstanceData);
+        }
+    }
+    allocator.trim();
+}
+
+void RenderPipeline::markHandlerDirty(size_t index) {
+    GraphicBatchHandler& handler = this->batch[index];
+    if (handler.isDirty) return;
+    handler.isDirty = true;
+    this->dirtyHandlers.push_back(index);
+}
+
+void RenderPipeline::updateHandler(size_t index, ComputeInstanceDataMode mode) {
+    GraphicCore& graphicCore = this->getRenderer().getGraphicCore();
+    // Computing may add graphics (e.g. text glyphs) and grow the batch, so re-fetch the handler
+    if (this->batch[index].graphic->computeInstanceData(graphicCore.getInstanceAllocator(), mode)) {
+        GraphicBatchHandler& handler = this->batch[index];
+        graphicCore.getInstanceUploader().markDynamicDataDirty(handler.dynamicDataCursor, handler.dynamicDataSize);
+        graphicCore.getInstanceUploader().markStaticDataDirty(handler.staticDataCursor, 1);
+    }
+}
+
+void RenderPipeline::updateDirtyHandlers() {
+    // One sweep over the transform hierarchy before the handlers read their model matrix
+    RaeptorCogs::Transforms().update();
+    // Indexed loop: computing a handler may mark others dirty
+    for (size_t i = 0; i < this->dirtyHandlers.size(); ++i) {
+        size_t index = this->dirtyHandlers[i];
+        // Skip handlers erased, cleaned or moved since they were marked
+        if (index >= this->batch.size() || !this->batch[index].isDirty) continue;
+        // Inherited state first, a new mask moves the handler; the children join this loop
+        Graphic2D* graphic = this->batch[index].graphic;
+        graphic->refreshInherited();
+        graphic->markChildrenDirty();
+        this->updateHandler(index, ComputeInstanceDataMode::NONE);
+        this->batch[index].isDirty = false;
+    }
+    this->dirtyHandlers.clear();
+}
+
+void RenderPipeline::rebuildTextureCommands(RenderList& renderList) {
+    for (const DrawCommand& command : renderList.getDrawCommands()) {
+        // A command shares one texture, so checking its first handler is enough
+        Texture texture = this->batch[command.handlerIndex].graphic->getTexture();
+        if (!texture || !texture->needsRebuild()) continue;
+        for (size_t slot = command.baseInstance; slot < command.baseInstance + command.instanceCount; ++slot) {
+            size_t index = this->batch.indexOf(renderList.getIndirectHandler(slot));
+            this->updateHandler(index, ComputeInstanceDataMode::REBUILD_TEXTURE);
+        }
+    }
+}
+
 void RenderPipeline::processBatch(std::function<void()> postDrawCallback) {
     GraphicCore& graphicCore = this->getRenderer().getGraphicCore();
-    Common::GraphicBatchHandler* firstHandler = nullptr;
-    size_t instanceOffset = 0;
-    bool textureIsDirty = false;
+
+    // Updates first: they may add or remove graphics before the list is compacted and sorted
+    this->updateDirtyHandlers();
 
     auto& renderList = this->getRenderList();
+    if (renderList.needsCompaction()) renderList.compact();
     if (renderList.empty()) return;
     if (renderList.needsReorder()) renderList.reorder();
-    graphicCore.updateGraphicGPUData();
-    for (auto [index, handler] : renderList) {
-
-        if (firstHandler != nullptr && !this->compatibleBatches(firstHandler, &handler)) {
-            this->drawBatch(firstHandler, instanceOffset, index - instanceOffset, postDrawCallback);
-            firstHandler = nullptr;
-            instanceOffset = index;
-        }
 
-        if (firstHandler == nullptr) {
-            firstHandler = &handler;
-            if (handler.graphic->getTexture()) {
-                textureIsDirty = handler.graphic->getTexture()->needsRebuild();
-            }
-        }
-        
-        if ((textureIsDirty || handler.isDirty) && handler.graphic->computeInstanceData(graphicCore.getInstanceAllocator(), textureIsDirty ? ComputeInstanceDataMode::REBUILD_TEXTURE : ComputeInstanceDataMode::NONE)) {            
-            graphicCore.getInstanceUploader().markDynamicDataDirty(handler.dynamicDataCursor, handler.dynamicDataSize);
-            graphicCore.getInstanceUploader().markStaticDataDirty(handler.staticDataCursor, 1);
-            graphicCore.updateGraphicGPUData();
-        }
+    if (renderList.needsDrawCommandsRebuild()) {
+        renderList.buildDrawCommands([this](const BatchKey& a, const BatchKey& b) {
+            return this->compatibleBatches(a, b);
+        });
     }
-    if (firstHandler != nullptr && instanceOffset < renderList.size()) {
-        this->drawBatch(firstHandler, instanceOffset, renderList.size() - instanceOffset, postDrawCallback);
+    this->rebuildTextureCommands(renderList);
+    graphicCore.updateGraphicGPUData();
+
+    for (const DrawCommand& command : renderList.getDrawCommands()) {
+        this->drawBatch(command, postDrawCallback);
     }
 }
 
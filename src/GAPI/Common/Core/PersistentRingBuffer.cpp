@@ -0,0 +1,104 @@
+#include <RaeptorCogs/GAPI/Common/Core/PersistentRingBuffer.hpp>
+#include <RaeptorCogs/External/glad/glad.hpp>
+#include <stdexcept>
+
+namespace RaeptorCogs::GAPI::Common {
+
+#ifndef __EMSCRIPTEN__
+
+PersistentRingBuffer::~PersistentRingBuffer() {
+    for (GLsync fence : this->fences) {
+        if (fence) glDeleteSync(fence);
+    }
+}
+
+void PersistentRingBuffer::reserve(size_t size) {
+    this->usedSize = size;
+    // Shrinks once the source uses under a quarter of a slice, e.g. after defragmentation
+    bool grow = size > this->sliceSize;
+    bool shrink = this->sliceSize > MIN_SLICE_SIZE && size * 4 < this->sliceSize;
+    if (!grow && !shrink) return;
+
+    static GLint alignment = 0;
+    if (alignment == 0) {
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    }
+    size_t newSliceSize = grow ? std::max({size, this->sliceSize * 2, MIN_SLICE_SIZE}) : std::max(size * 2, MIN_SLICE_SIZE);
+    newSliceSize = (newSliceSize + static_cast<size_t>(alignment) - 1) / static_cast<size_t>(alignment) * static_cast<size_t>(alignment);
+
+    // The old storage is released once the GPU is done with it, its fences are no longer needed
+    for (GLsync& fence : this->fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    this->storage = RaeptorCogs::GAPI::ObjectHandler<SSBO>();
+    this->storage->bind();
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr storageSize = static_cast<GLsizeiptr>(newSliceSize * SLICE_COUNT);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, storageSize, nullptr, flags);
+    this->mapped = static_cast<unsigned char*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, storageSize, flags));
+    if (!this->mapped) {
+        throw std::runtime_error("Failed to map the persistent ring buffer storage.");
+    }
+    this->sliceSize = newSliceSize;
+    // Nothing reads the new storage yet, the current slice can be written in place
+    this->sliceBound = false;
+    for (auto& regions : this->pendingRegions) {
+        regions.assign(1, Region(0, size));
+    }
+}
+
+void PersistentRingBuffer::nextSlice() {
+    // Every draw reading the slice has been issued, the fence follows them
+    GLsync& done = this->fences[this->currentSlice];
+    if (done) glDeleteSync(done);
+    done = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    this->sliceBound = false;
+
+    this->currentSlice = (this->currentSlice + 1) % SLICE_COUNT;
+    GLsync& fence = this->fences[this->currentSlice];
+    if (!fence) return;
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    while (status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+UploadStats PersistentRingBuffer::write(const std::vector<Region>& regions, size_t size, const SourceCopy& copy) {
+    UploadStats stats;
+    this->reserve(size);
+    for (auto& pending : this->pendingRegions) {
+        pending.insert(pending.end(), regions.begin(), regions.end());
+    }
+
+    if (this->pendingRegions[this->currentSlice].empty()) return stats;
+    // Draws issued since the last write may still read this slice
+    if (this->sliceBound) this->nextSlice();
+
+    auto& pending = this->pendingRegions[this->currentSlice];
+    CoalesceRegions(pending);
+    unsigned char* slice = this->mapped + this->currentSlice * this->sliceSize;
+    for (auto [begin, end] : pending) {
+        end = std::min(end, this->usedSize);
+        if (begin >= end) continue;
+        copy(begin, end, slice + begin);
+        stats.uploadCount++;
+        stats.uploadedBytes += end - begin;
+    }
+    pending.clear();
+    return stats;
+}
+
+void PersistentRingBuffer::bind(unsigned int binding) {
+    if (!this->mapped) return;
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, this->storage->getID(),
+        static_cast<GLintptr>(this->currentSlice * this->sliceSize),
+        static_cast<GLsizeiptr>(this->sliceSize));
+    this->sliceBound = true;
+}
+
+#endif
+
+}
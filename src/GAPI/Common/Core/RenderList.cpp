@@ -2,9 +2,10 @@
 #include <RaeptorCogs/GAPI/Common/RendererBackend.hpp>
 #include <RaeptorCogs/Graphic.hpp>
 #include <RaeptorCogs/External/glad/glad.hpp>
-
-constexpr int MAX_SPRITES = 8000000;
-constexpr int INDEX_INDIRECTION_SIZE = (MAX_SPRITES * sizeof(int));
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+#include <string>
 
 namespace RaeptorCogs::GAPI::Common {
 
@@ -13,6 +14,9 @@ GraphicBatchHandler& RenderList::getHandler(size_t index) {
 }
 
 GraphicBatchHandler& RenderList::getIndirectHandler(size_t index) {
+    if (index >= orderIndices.size() || orderIndices[index] == TOMBSTONE) {
+        throw std::runtime_error("RenderList::getIndirectHandler: no handler at slot " + std::to_string(index));
+    }
     return batch[orderIndices[index]];
 }
 
@@ -24,16 +28,12 @@ GraphicBatchHandler& RenderList::createHandler(BatchKey key, Graphic2D* graphic,
         graphic->computeInstanceData(instanceAllocator, ComputeInstanceDataMode::FORCE_REBUILD);
         // Move the handler to fill any gaps if needed
         if (handler->staticDataCursor < this->batch.size() - 1) {
-            this->batch[handler->staticDataCursor] = *handler;
+            this->batch.move(this->batch.size() - 1, handler->staticDataCursor);
             this->batch.pop_back();
             handler = &this->batch[handler->staticDataCursor];
             graphic->setBatchHandlerCursor(handler->staticDataCursor);
         }
-        this->orderIndices.push_back(handler->staticDataCursor);
-        if ((this->size() > 1 && this->getIndirectHandler(this->orderIndices.size() - 2).rendererKey > handler->rendererKey) || this->needsReorder()) {
-            this->markDirty(*handler);
-        }
-        this->flags |= RenderListFlags::REORDERED;
+        this->insert(handler->staticDataCursor);
     } else {
         handler = &graphic->getBatchHandler();
     }
@@ -43,34 +43,174 @@ GraphicBatchHandler& RenderList::createHandler(BatchKey key, Graphic2D* graphic,
 
 RenderList::RenderList(BatchBuffer& batch) : batch(batch), flags(RenderListFlags::NONE) {}
 
-void RenderList::bind() {
-    if (!(flags & RenderListFlags::SSBO_CREATED)) {
-        this->indexIndirectionSSBO->bind();
-        glBufferData(GL_SHADER_STORAGE_BUFFER, INDEX_INDIRECTION_SIZE, nullptr, GL_DYNAMIC_DRAW);
-        this->flags |= RenderListFlags::SSBO_CREATED;
+size_t RenderList::GetIndirectionCapacity(size_t capacity, size_t size) {
+    if (capacity < MIN_INDIRECTION_CAPACITY) capacity = MIN_INDIRECTION_CAPACITY;
+    while (capacity < size) capacity *= 2;
+    while (capacity > MIN_INDIRECTION_CAPACITY && size < capacity / 4) capacity /= 2;
+    return capacity;
+}
+
+uint64_t RenderList::GetBucketKey(const BatchKey& key, float zRange) {
+    if (zRange <= 0.0f) return key.getSortKey();
+    float layer = std::floor(key.getZIndex() / zRange) * zRange;
+    return (key.getSortKey() & ~BatchKey::ZINDEX_FIELD)
+        | (static_cast<uint64_t>(BatchKey::EncodeZIndex(layer)) << BatchKey::ZINDEX_SHIFT);
+}
+
+bool RenderList::fitIndirection() {
+    size_t capacity = GetIndirectionCapacity(indirectionCapacity, orderIndices.size());
+    if (capacity == indirectionCapacity) return false;
+
+    RaeptorCogs::GAPI::ObjectHandler<Common::SSBO> resized;
+    resized->bind();
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(unsigned int)), nullptr, GL_DYNAMIC_DRAW);
+
+    // Slots outside the pending upload are only on the GPU
+    const auto& regions = this->getUploadRegions();
+    bool coveredByUpload = regions.size() == 1 && regions[0] == Region(0, orderIndices.size());
+    size_t kept = std::min({indirectionCapacity, capacity, orderIndices.size()});
+    if (kept > 0 && !coveredByUpload) {
+        glBindBuffer(GL_COPY_READ_BUFFER, indexIndirectionSSBO->getID());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, resized->getID());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(kept * sizeof(unsigned int)));
     }
+    std::swap(this->indexIndirectionSSBO, resized);
+    indirectionCapacity = capacity;
+    return true;
+}
+
+void RenderList::bind() {
+    this->fitIndirection();
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, indexIndirectionSSBO->getID());
 }
 
+void RenderList::insert(unsigned int index) {
+    if (index >= orderPositions.size()) {
+        size_t capacity = std::max<size_t>(index + 1, orderPositions.size() * 2);
+        orderPositions.resize(capacity, NO_POSITION);
+        dirtyMarks.resize(std::max(capacity, dirtyMarks.size()), 0);
+    }
+    orderPositions[index] = static_cast<unsigned int>(orderIndices.size());
+    orderIndices.push_back(index);
+    this->markUploadRange(orderIndices.size() - 1, orderIndices.size());
+
+    if (this->bucketed) {
+        this->moveToBucket(index, buckets.size());
+        return;
+    }
+
+    // A tombstone may hide the previous handler, let the reorder sort it out
+    if (this->tombstoneCount || this->needsReorder()) {
+        this->markDirty(batch[index]);
+    } else if (orderIndices.size() > 1 && batch.getKey(orderIndices[orderIndices.size() - 2]) > batch.getKey(index)) {
+        this->markDirty(batch[index]);
+    }
+}
+
+void RenderList::remove(unsigned int index) {
+    unsigned int position = this->getPosition(index);
+    if (position == NO_POSITION) return;
+    if (this->bucketed) {
+        // Past the last bucket the handler holds the last slot, dropped right away
+        size_t source = this->findBucket(position);
+        this->handOverSlot(position, source, buckets.size());
+        if (buckets[source].begin == buckets[source].end) {
+            buckets.erase(buckets.begin() + static_cast<std::ptrdiff_t>(source));
+        }
+        orderIndices.pop_back();
+        orderPositions[index] = NO_POSITION;
+        this->flags |= RenderListFlags::DRAW_COMMANDS_OUTDATED;
+        return;
+    }
+    orderIndices[position] = TOMBSTONE;
+    orderPositions[index] = NO_POSITION;
+    tombstoneCount++;
+    firstTombstone = std::min<size_t>(firstTombstone, position);
+    this->flags |= RenderListFlags::NEEDS_COMPACTION;
+}
+
+unsigned int RenderList::getPosition(unsigned int index) const {
+    return index < orderPositions.size() ? orderPositions[index] : NO_POSITION;
+}
+
+bool RenderList::contains(unsigned int index) const {
+    return this->getPosition(index) != NO_POSITION;
+}
+
+bool RenderList::needsCompaction() const {
+    return RenderListFlags::NEEDS_COMPACTION == (flags & RenderListFlags::NEEDS_COMPACTION);
+}
+
+void RenderList::compact() {
+    if (tombstoneCount == 0) return;
+    size_t write = firstTombstone;
+    for (size_t read = firstTombstone; read < orderIndices.size(); ++read) {
+        unsigned int index = orderIndices[read];
+        if (index == TOMBSTONE) continue;
+        orderIndices[write] = index;
+        orderPositions[index] = static_cast<unsigned int>(write);
+        ++write;
+    }
+    this->markUploadRange(firstTombstone, write);
+    orderIndices.resize(write);
+    tombstoneCount = 0;
+    firstTombstone = SIZE_MAX;
+    // Trailing tombstones move nothing, the draw commands still cover them
+    this->flags |= RenderListFlags::DRAW_COMMANDS_OUTDATED;
+    this->flags &= ~RenderListFlags::NEEDS_COMPACTION;
+}
+
 bool RenderList::empty() const {
-    return orderIndices.empty();
+    return orderIndices.size() == tombstoneCount;
 }
 
 void RenderList::clear() {
+    for (unsigned int index : orderIndices) {
+        if (index != TOMBSTONE) orderPositions[index] = NO_POSITION;
+    }
     orderIndices.clear();
+    for (unsigned int index : dirtyIndices) {
+        dirtyMarks[index] = 0;
+    }
+    dirtyIndices.clear();
+    tombstoneCount = 0;
+    firstTombstone = SIZE_MAX;
+    uploadRegions.clear();
+    drawCommands.clear();
+    buckets.clear();
     flags = RenderListFlags::NONE;
 }
 
 void RenderList::erase(GraphicBatchHandler& handler, InstanceAllocator& instanceAllocator) {
-    size_t index = static_cast<size_t>(&handler - &batch[0]);
+    unsigned int index = static_cast<unsigned int>(batch.indexOf(handler));
     auto& renderLists = handler.graphic->getRenderLists();
     renderLists.erase(std::remove(renderLists.begin(), renderLists.end(), this), renderLists.end());
     if (handler.graphic->getRenderListCount() == 0) {
         instanceAllocator.free(handler);
         handler.graphic->setBatchHandlerCursor(SIZE_MAX);
+        handler.isDirty = false;
     }
-    orderIndices.erase(std::remove(orderIndices.begin(), orderIndices.end(), index), orderIndices.end());
-    this->flags |= RenderListFlags::REORDERED;
+    this->remove(index);
+}
+
+void RenderList::relocate(unsigned int from, unsigned int to) {
+    unsigned int position = this->getPosition(from);
+    if (position == NO_POSITION) return;
+    if (to >= orderPositions.size()) {
+        orderPositions.resize(to + 1, NO_POSITION);
+    }
+    orderIndices[position] = to;
+    orderPositions[to] = position;
+    orderPositions[from] = NO_POSITION;
+
+    // A pending reorder must see the handler at its new index
+    if (from < dirtyMarks.size() && dirtyMarks[from]) {
+        dirtyMarks[from] = 0;
+        if (to >= dirtyMarks.size()) dirtyMarks.resize(to + 1, 0);
+        dirtyMarks[to] = 1;
+        std::replace(dirtyIndices.begin(), dirtyIndices.end(), from, to);
+    }
+    this->markUploadRange(position, position + 1);
 }
 
 bool RenderList::needsReorder() const {
@@ -81,68 +221,414 @@ bool RenderList::wasReordered() const {
     return RenderListFlags::REORDERED == (flags & RenderListFlags::REORDERED);
 }
 
-void RenderList::binarySearchReorder(const GraphicBatchHandler& handler) {
-    auto& batch = this->batch;
-    auto key = handler.rendererKey;
+void RenderList::binarySearchReorder(unsigned int index) {
+    unsigned int position = this->getPosition(index);
+    if (position == NO_POSITION) return;
+    const BatchKey* keys = batch.getKeys();
+    BatchKey key = keys[index];
 
-    size_t pos = static_cast<size_t>(&handler - &batch[0]);
-    auto it = std::find(orderIndices.begin(), orderIndices.end(), pos);
-    if (it != orderIndices.end()) {
-        pos = static_cast<size_t>(std::distance(orderIndices.begin(), it));
+    // Lower bound over the sorted subsequence, skipping handlers that have yet to be moved
+    size_t low = 0;
+    size_t high = orderIndices.size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        size_t probe = mid;
+        while (probe < high && (probe == position || dirtyMarks[orderIndices[probe]])) {
+            ++probe;
+        }
+        if (probe < high && keys[orderIndices[probe]] < key) {
+            low = probe + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    size_t target = low > position ? low - 1 : low;
+    this->moveSlot(position, target);
+}
+
+bool RenderList::localReorder(size_t budget) {
+    const BatchKey* keys = batch.getKeys();
+    for (unsigned int index : dirtyIndices) {
+        if (!dirtyMarks[index]) continue;
+        unsigned int position = this->getPosition(index);
+        if (position == NO_POSITION) {
+            dirtyMarks[index] = 0;
+            continue;
+        }
+        const BatchKey& key = keys[index];
+
+        // Walk past strictly larger handlers on the left, else strictly smaller ones on the right
+        size_t target = position;
+        for (size_t probe = position; probe > 0; --probe) {
+            if (budget-- == 0) return false;
+            unsigned int other = orderIndices[probe - 1];
+            if (dirtyMarks[other]) continue;
+            if (!(key < keys[other])) break;
+            target = probe - 1;
+        }
+        if (target == position) {
+            for (size_t probe = position + 1; probe < orderIndices.size(); ++probe) {
+                if (budget-- == 0) return false;
+                unsigned int other = orderIndices[probe];
+                if (dirtyMarks[other]) continue;
+                if (!(keys[other] < key)) break;
+                target = probe;
+            }
+        }
+        dirtyMarks[index] = 0;
+        this->moveSlot(position, target);
+    }
+    return true;
+}
+
+double RenderList::estimateDisplacement() const {
+    const BatchKey* keys = batch.getKeys();
+    auto keyLess = [keys](unsigned int index, const BatchKey& key) { return keys[index] < key; };
+    auto lessKey = [keys](const BatchKey& key, unsigned int index) { return key < keys[index]; };
+    size_t step = std::max<size_t>(1, dirtyIndices.size() / DISPLACEMENT_SAMPLES);
+    size_t total = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < dirtyIndices.size(); i += step) {
+        unsigned int index = dirtyIndices[i];
+        size_t position = this->getPosition(index);
+        if (position == NO_POSITION) continue;
+        // The other handlers are nearly sorted, a plain search over them is close enough
+        size_t low = static_cast<size_t>(std::lower_bound(orderIndices.begin(), orderIndices.end(), keys[index], keyLess) - orderIndices.begin());
+        size_t high = static_cast<size_t>(std::upper_bound(orderIndices.begin(), orderIndices.end(), keys[index], lessKey) - orderIndices.begin());
+        if (position < low) total += low - position;
+        else if (position > high) total += position - high;
+        ++count;
+    }
+    return count ? static_cast<double>(total) / static_cast<double>(count) : 0.0;
+}
+
+void RenderList::moveSlot(size_t position, size_t target) {
+    if (target == position) return;
+    unsigned int index = orderIndices[position];
+    if (target > position) {
+        std::memmove(&orderIndices[position], &orderIndices[position + 1], (target - position) * sizeof(unsigned int));
     } else {
-        pos = SIZE_MAX;
+        std::memmove(&orderIndices[target + 1], &orderIndices[target], (position - target) * sizeof(unsigned int));
     }
+    orderIndices[target] = index;
+
+    size_t first = std::min(position, target);
+    size_t last = std::max(position, target) + 1;
+    this->updatePositions(first, last);
+    this->markUploadRange(first, last);
+}
 
-    if (pos == SIZE_MAX) {
-        return; // Handler not found in orderIndices
+void RenderList::updatePositions(size_t first, size_t last) {
+    for (size_t slot = first; slot < last; ++slot) {
+        orderPositions[orderIndices[slot]] = static_cast<unsigned int>(slot);
     }
-    // Remove the index from orderIndices
-    size_t index = orderIndices[pos];
-    orderIndices.erase(orderIndices.begin() + static_cast<std::vector<size_t>::difference_type>(pos));
+}
+
+void RenderList::markUploadRange(size_t first, size_t last) {
+    if (first >= last) return;
+    uploadRegions.mark(first, last);
+    this->flags |= RenderListFlags::REORDERED | RenderListFlags::DRAW_COMMANDS_OUTDATED;
+}
 
-    // Find the new position using binary search
-    auto newPos = std::lower_bound(orderIndices.begin(), orderIndices.end(), index, [&batch, &key](size_t a, size_t) {
-        return batch[a].rendererKey < key;
+void RenderList::radixReorder() {
+    const BatchKey* keys = batch.getKeys();
+    radixSorter.sort(orderIndices, [keys](unsigned int index) {
+        return keys[index].getSortKey();
     });
+}
 
-    // Insert the index at the new position
-    orderIndices.insert(newPos, static_cast<unsigned int>(&handler - &batch[0]));
+void RenderList::comparisonReorder() {
+    const BatchKey* keys = batch.getKeys();
+    std::sort(orderIndices.begin(), orderIndices.end(), [keys](size_t a, size_t b) {
+        return keys[a] < keys[b];
+    });
 }
 
-void RenderList::radixReorder() {
-    // Implement radix sort based on the BatchKey fields
-    // This is a placeholder for the actual radix sort implementation
-    // For simplicity, we will use std::sort here, but in a real scenario,
-    // you would implement a proper radix sort for better performance.
-    auto& batch = this->batch;
-    std::sort(orderIndices.begin(), orderIndices.end(), [&batch](size_t a, size_t b) {
-        return batch[a].rendererKey < batch[b].rendererKey;
+void RenderList::mergeReorder() {
+    const BatchKey* keys = batch.getKeys();
+    auto& extracted = this->mergeScratch;
+    extracted.clear();
+
+    size_t firstSlot = orderIndices.size();
+    for (unsigned int index : dirtyIndices) {
+        unsigned int position = this->getPosition(index);
+        if (position == NO_POSITION) continue;
+        extracted.push_back(index);
+        firstSlot = std::min<size_t>(firstSlot, position);
+    }
+    if (extracted.empty()) return;
+
+    // Pull the dirty handlers out, the remainder stays sorted
+    size_t write = firstSlot;
+    for (size_t read = firstSlot; read < orderIndices.size(); ++read) {
+        unsigned int index = orderIndices[read];
+        if (!dirtyMarks[index]) orderIndices[write++] = index;
+    }
+
+    if (extracted.size() >= RADIX_SORT_THRESHOLD) {
+        radixSorter.sort(extracted, [keys](unsigned int index) {
+            return keys[index].getSortKey();
+        });
+    } else {
+        std::sort(extracted.begin(), extracted.end(), [keys](unsigned int a, unsigned int b) {
+            return keys[a] < keys[b];
+        });
+    }
+
+    // Merge from the back so that no slot is overwritten before it is read
+    size_t remainder = write;
+    size_t pending = extracted.size();
+    size_t out = orderIndices.size();
+    while (pending > 0) {
+        unsigned int candidate = extracted[pending - 1];
+        if (remainder > 0 && keys[candidate] < keys[orderIndices[remainder - 1]]) {
+            orderIndices[--out] = orderIndices[--remainder];
+        } else {
+            orderIndices[--out] = candidate;
+            --pending;
+        }
+    }
+
+    size_t first = std::min(firstSlot, out);
+    this->updatePositions(first, orderIndices.size());
+    this->markUploadRange(first, orderIndices.size());
+}
+
+void RenderList::swapSlots(size_t first, size_t second) {
+    if (first == second) return;
+    std::swap(orderIndices[first], orderIndices[second]);
+    orderPositions[orderIndices[first]] = static_cast<unsigned int>(first);
+    orderPositions[orderIndices[second]] = static_cast<unsigned int>(second);
+    this->markUploadRange(first, first + 1);
+    this->markUploadRange(second, second + 1);
+}
+
+size_t RenderList::findBucket(size_t slot) const {
+    auto it = std::upper_bound(buckets.begin(), buckets.end(), slot, [](size_t value, const RenderBucket& bucket) {
+        return value < bucket.begin;
     });
+    return static_cast<size_t>(it - buckets.begin()) - 1;
+}
+
+void RenderList::moveToBucket(unsigned int index, size_t source) {
+    size_t position = this->getPosition(index);
+    uint64_t key = GetBucketKey(batch.getKey(index), bucketRange);
+    if (source < buckets.size() && buckets[source].key == key) return;
+
+    auto it = std::lower_bound(buckets.begin(), buckets.end(), key, [](const RenderBucket& bucket, uint64_t value) {
+        return bucket.key < value;
+    });
+    size_t target = static_cast<size_t>(it - buckets.begin());
+    if (it == buckets.end() || it->key != key) {
+        // A new bucket opens empty between its neighbours
+        size_t slot = it != buckets.end() ? it->begin : (buckets.empty() ? 0 : buckets.back().end);
+        buckets.insert(it, {key, slot, slot});
+        if (target <= source) ++source;
+    }
+
+    this->handOverSlot(position, source, target);
+    if (source < buckets.size() && buckets[source].begin == buckets[source].end) {
+        buckets.erase(buckets.begin() + static_cast<std::ptrdiff_t>(source));
+    }
+}
+
+size_t RenderList::handOverSlot(size_t position, size_t source, size_t target) {
+    // Each bucket in between trades its edge handler for the slot, staying contiguous
+    if (target > source) {
+        this->swapSlots(position, buckets[source].end - 1);
+        position = --buckets[source].end;
+        for (size_t next = source + 1; next < target; ++next) {
+            --buckets[next].begin;
+            this->swapSlots(position, buckets[next].end - 1);
+            position = --buckets[next].end;
+        }
+        if (target < buckets.size()) --buckets[target].begin;
+    } else if (target < source) {
+        if (source < buckets.size()) {
+            this->swapSlots(position, buckets[source].begin);
+            position = buckets[source].begin++;
+        }
+        for (size_t next = source - 1; next > target; --next) {
+            ++buckets[next].end;
+            this->swapSlots(position, buckets[next].begin);
+            position = buckets[next].begin++;
+        }
+        ++buckets[target].end;
+    }
+    return position;
+}
+
+void RenderList::sortBuckets() {
+    const BatchKey* keys = batch.getKeys();
+    float range = bucketRange;
+    if (orderIndices.size() >= RADIX_SORT_THRESHOLD) {
+        radixSorter.sort(orderIndices, [keys, range](unsigned int index) {
+            return GetBucketKey(keys[index], range);
+        });
+    } else {
+        std::sort(orderIndices.begin(), orderIndices.end(), [keys, range](unsigned int a, unsigned int b) {
+            return GetBucketKey(keys[a], range) < GetBucketKey(keys[b], range);
+        });
+    }
+    this->updatePositions(0, orderIndices.size());
+    this->markUploadRange(0, orderIndices.size());
+
+    buckets.clear();
+    if (!this->bucketed) return;
+    for (size_t slot = 0; slot < orderIndices.size(); ++slot) {
+        uint64_t key = GetBucketKey(keys[orderIndices[slot]], range);
+        if (buckets.empty() || buckets.back().key != key) {
+            buckets.push_back({key, slot, slot});
+        }
+        buckets.back().end = slot + 1;
+    }
+}
+
+void RenderList::bucketReorder() {
+    // Each move swaps one slot per bucket crossed, past the list size a sort is cheaper
+    if (dirtyIndices.size() * std::max<size_t>(buckets.size(), 1) > orderIndices.size()) {
+        this->sortBuckets();
+    } else {
+        for (unsigned int index : dirtyIndices) {
+            unsigned int position = this->getPosition(index);
+            if (position == NO_POSITION) continue;
+            this->moveToBucket(index, this->findBucket(position));
+        }
+    }
+    for (unsigned int index : dirtyIndices) {
+        dirtyMarks[index] = 0;
+    }
+    dirtyIndices.clear();
+    this->flags &= ~RenderListFlags::NEEDS_REORDER;
+    this->flags |= RenderListFlags::DRAW_COMMANDS_OUTDATED;
 }
 
 void RenderList::reorder() {
-    // Choose between binary search reorder or radix reorder based on the number of dirty indices
-    if (dirtyHandlers.size() < orderIndices.size() / 4) {
-        for (auto& handler : dirtyHandlers) {
-            binarySearchReorder(handler);
+    this->compact();
+    if (this->bucketed) {
+        this->bucketReorder();
+        return;
+    }
+    // Nearly sorted lists: walking each handler to its slot beats a search or a pass over the list
+    double size = static_cast<double>(orderIndices.size());
+    double displacement = dirtyIndices.empty() ? 0.0 : this->estimateDisplacement();
+    double localCost = static_cast<double>(dirtyIndices.size()) * (displacement + 1.0);
+    bool placed = false;
+    if (localCost <= size * LOCAL_REORDER_RATIO
+        && (dirtyIndices.size() > INCREMENTAL_REORDER_LIMIT || displacement <= std::log2(size + 1.0))) {
+        placed = this->localReorder(static_cast<size_t>(2.0 * size * LOCAL_REORDER_RATIO));
+        // Misjudged lists hand the handlers left over to the other strategies
+        if (!placed) {
+            dirtyIndices.erase(std::remove_if(dirtyIndices.begin(), dirtyIndices.end(), [this](unsigned int index) {
+                return !dirtyMarks[index];
+            }), dirtyIndices.end());
         }
+    }
+
+    // Choose between moving the dirty handlers one by one, merging them back or a full sort
+    if (placed) {
+        // Nothing left to move
+    } else if (dirtyIndices.size() <= INCREMENTAL_REORDER_LIMIT) {
+        for (unsigned int index : dirtyIndices) {
+            dirtyMarks[index] = 0;
+            binarySearchReorder(index);
+        }
+    } else if (static_cast<double>(dirtyIndices.size()) <= static_cast<double>(orderIndices.size()) * MERGE_REORDER_RATIO) {
+        mergeReorder();
     } else {
-        radixReorder();
+        if (orderIndices.size() >= RADIX_SORT_THRESHOLD) {
+            radixReorder();
+        } else {
+            comparisonReorder();
+        }
+        this->updatePositions(0, orderIndices.size());
+        this->markUploadRange(0, orderIndices.size());
     }
-    dirtyHandlers.clear();
-    this->flags |= RenderListFlags::REORDERED;
+    for (unsigned int index : dirtyIndices) {
+        dirtyMarks[index] = 0;
+    }
+    dirtyIndices.clear();
+    // Batch keys changed even if no slot moved
+    this->flags &= ~RenderListFlags::NEEDS_REORDER;
+    this->flags |= RenderListFlags::DRAW_COMMANDS_OUTDATED;
+}
+
+void RenderList::setSortThreadCount(unsigned int count) {
+    radixSorter.setThreadCount(count);
+}
+
+void RenderList::setBucketed(bool enabled, float zRange) {
+    this->compact();
+    this->bucketed = enabled;
+    this->bucketRange = enabled ? zRange : 0.0f;
+    // The sort places the dirty handlers too
+    for (unsigned int index : dirtyIndices) {
+        dirtyMarks[index] = 0;
+    }
+    dirtyIndices.clear();
+    this->sortBuckets();
     this->flags &= ~RenderListFlags::NEEDS_REORDER;
 }
 
 void RenderList::markDirty(GraphicBatchHandler& handler) {
-    dirtyHandlers.push_back(handler);
+    unsigned int index = static_cast<unsigned int>(batch.indexOf(handler));
+    if (index >= dirtyMarks.size()) {
+        dirtyMarks.resize(index + 1, 0);
+    }
+    if (!dirtyMarks[index]) {
+        dirtyMarks[index] = 1;
+        dirtyIndices.push_back(index);
+    }
     this->flags |= RenderListFlags::NEEDS_REORDER;
 }
 
+bool RenderList::needsDrawCommandsRebuild() const {
+    return RenderListFlags::DRAW_COMMANDS_OUTDATED == (flags & RenderListFlags::DRAW_COMMANDS_OUTDATED);
+}
+
+void RenderList::buildDrawCommands(const BatchCompatibility& compatible) {
+    const BatchKey* keys = batch.getKeys();
+    drawCommands.clear();
+    size_t first = 0;
+    for (size_t slot = 1; slot <= orderIndices.size(); ++slot) {
+        if (slot < orderIndices.size() && compatible(keys[orderIndices[first]], keys[orderIndices[slot]])) continue;
+        const BatchKey& key = keys[orderIndices[first]];
+        drawCommands.push_back({
+            orderIndices[first],
+            key.getTextureSlot(),
+            key.isWriting(),
+            static_cast<unsigned int>(first),
+            static_cast<unsigned int>(slot - first)
+        });
+        first = slot;
+    }
+    this->flags &= ~RenderListFlags::DRAW_COMMANDS_OUTDATED;
+}
+
+Region RenderList::getUploadRange() const {
+    return uploadRegions.getBounds(orderIndices.size());
+}
+
+const std::vector<Region>& RenderList::getUploadRegions() {
+    return uploadRegions.resolve(orderIndices.size(), InstanceUploader::UPLOAD_CALL_COST / sizeof(unsigned int), FULL_UPLOAD_RATIO);
+}
+
 void RenderList::uploadOrderIndices() {
+    // Handlers added since bind may not fit anymore
+    if (this->fitIndirection()) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, indexIndirectionSSBO->getID());
+    }
+    const auto& regions = this->getUploadRegions();
+    if (!regions.empty()) indexIndirectionSSBO->bind();
+    for (auto [first, last] : regions) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+            static_cast<GLintptr>(first * sizeof(unsigned int)),
+            static_cast<GLsizeiptr>((last - first) * sizeof(unsigned int)),
+            this->orderIndices.data() + first);
+    }
     this->flags &= ~RenderListFlags::REORDERED;
-    indexIndirectionSSBO->bind();
-    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(this->orderIndices.size() * sizeof(int)), this->orderIndices.data());
+    uploadRegions.clear();
 }
 
 }
\ No newline at end of file
@@ -15,7 +15,9 @@
 namespace RaeptorCogs::GAPI::GL {
 
 void RenderPipeline::beginFrame() {
-    //
+    this->getRenderer().getGraphicCore().resetUploadStats();
+    this->compactRenderLists();
+    this->defragmentInstances();
 }
 
 void RenderPipeline::endFrame() {
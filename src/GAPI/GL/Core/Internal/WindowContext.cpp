@@ -40,15 +40,8 @@ namespace RaeptorCogs::GAPI::GL {
 
         this->quadVertexArray.get()->unbind(); 
 
-        // Shader Storage Buffer Object (SSBO) for instance data
-        #ifndef __EMSCRIPTEN__
-        backend.getGraphicCore().getStaticInstanceDataSSBO()->bind();
-        glBufferData(GL_SHADER_STORAGE_BUFFER, STATIC_INSTANCE_DATA_SIZE, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, backend.getGraphicCore().getStaticInstanceDataSSBO()->getID()); // binding = 1
-        backend.getGraphicCore().getDynamicInstanceDataSSBO()->bind();
-        glBufferData(GL_SHADER_STORAGE_BUFFER, DEFAULT_DYNAMIC_DATA_BUFFER_SIZE, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, backend.getGraphicCore().getDynamicInstanceDataSSBO()->getID()); // binding = 2
-        #else
+        // The instance data SSBOs are sized and bound by the instance uploader, see InstanceUploader::upload
+        #ifdef __EMSCRIPTEN__
         backend.getIDataTex()->bind();
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, IDATATEX_WIDTH, IDATATEX_HEIGHT, 0, GL_RGBA, GL_FLOAT, nullptr);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
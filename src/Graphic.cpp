@@ -6,6 +6,14 @@ namespace RaeptorCogs {
 
 #pragma region Graphic
 
+namespace {
+
+Graphic2D* ParentGraphic(Node* parent) {
+    return parent && parent->isInstanceOf<Graphic2D>() ? static_cast<Graphic2D*>(parent) : nullptr;
+}
+
+}
+
 Graphic2D::~Graphic2D() {
     if (renderer) {
         renderer->remove(*this); // Remove from renderer if it exists
@@ -34,32 +42,33 @@ bool Graphic2D::computeInstanceData(GAPI::Common::InstanceAllocator&, ComputeIns
     throw std::runtime_error("Graphic2D::computeInstanceData must be overridden in derived classes.");
 }
 
+// Mask IDs go in the batch key and the instance data as is, they must fit both
+static_assert(Graphic2D::MAX_MASK_ID <= GAPI::Common::COMPACT_MAX_MASK_ID, "Compact instances must hold every mask ID a graphic accepts");
+
+static void CheckMaskID(int index) {
+    if (index < 0 || index > Graphic2D::MAX_MASK_ID) {
+        throw std::runtime_error("Mask ID " + std::to_string(index) + " out of range [0, " + std::to_string(Graphic2D::MAX_MASK_ID) + "]");
+    }
+}
+
 void Graphic2D::setReadingMaskID(int index, bool inheritFromParent) {
+    CheckMaskID(index);
     if (inheritFromParent && !this->hasFlag(GraphicFlags::INHERIT_READ_MASK)) return;
     if (!inheritFromParent && index != 0) this->clearFlag(GraphicFlags::INHERIT_READ_MASK);
     this->readingMaskIndex = index;
     this->updatePositionInRenderLists();
-    if (!this->getWritingMaskID())
-        for (Node* child : this->getChildren()) {
-            if (child->isInstanceOf<Graphic2D>()) {
-                static_cast<Graphic2D*>(child)->setReadingMaskID(index, true);
-            }
-        }
-    this->setDataDirty(true);
+    this->setInheritedDirty();
 }
 
 void Graphic2D::setWritingMaskID(int index) {
+    CheckMaskID(index);
     this->writingMaskIndex = index;
     this->updatePositionInRenderLists();
-    for (Node* child : this->getChildren()) {
-        if (child->isInstanceOf<Graphic2D>()) {
-            static_cast<Graphic2D*>(child)->setReadingMaskID(index, true);
-        }
-    }
-    this->setDataDirty(true);
+    this->setInheritedDirty();
 }
 
-int Graphic2D::getReadingMaskID() const {
+int Graphic2D::getReadingMaskID() {
+    this->refreshInherited();
     return this->readingMaskIndex;
 }
 
@@ -75,7 +84,7 @@ void Graphic2D::setDataDirty(bool dirty) {
     if (dirty) {
         this->setFlag(GraphicFlags::DATA_DIRTY);
         if (this->getRenderListCount()) {
-            this->getBatchHandler().isDirty = true;
+            RaeptorCogs::Renderer().getBackend().getRenderPipeline().markHandlerDirty(this->batchHandlerCursor);
         }
     } else {
         this->clearFlag(GraphicFlags::DATA_DIRTY);
@@ -87,17 +96,73 @@ void Graphic2D::setDataDirty(bool dirty) {
 
 void Graphic2D::setParent(Node* parent) {
     Node::setParent(parent);
-    this->setReadingMaskID(parent && parent->isInstanceOf<Graphic2D>() ? (static_cast<Graphic2D*>(parent)->getWritingMaskID() ? static_cast<Graphic2D*>(parent)->getWritingMaskID() : static_cast<Graphic2D*>(parent)->getReadingMaskID()) : 0, true);
+    this->setInheritedDirty();
+}
+
+void Graphic2D::inheritFrom(Graphic2D* parent) {
+    this->setDataDirty(true);
+    if (!this->hasFlag(GraphicFlags::INHERIT_READ_MASK)) return;
+    int index = 0;
+    if (parent) index = parent->writingMaskIndex ? parent->writingMaskIndex : parent->readingMaskIndex;
+    if (index == this->readingMaskIndex) return;
+    this->readingMaskIndex = index;
+    this->updatePositionInRenderLists();
+}
+
+void Graphic2D::setInheritedDirty() {
+    this->setFlag(GraphicFlags::INHERITED_DIRTY);
+    this->setChildrenDirty();
+}
+
+void Graphic2D::setChildrenDirty() {
+    this->setDataDirty(true);
+    this->setFlag(GraphicFlags::CHILDREN_DIRTY);
+    // No pipeline pass reaches graphics outside the render lists
+    if (!this->getRenderListCount()) this->markChildrenDirty();
+}
+
+void Graphic2D::markChildrenDirty() {
+    if (!this->hasFlag(GraphicFlags::CHILDREN_DIRTY)) return;
+    this->clearFlag(GraphicFlags::CHILDREN_DIRTY);
+    for (Node* child : this->getChildren()) {
+        if (child->isInstanceOf<Graphic2D>()) {
+            static_cast<Graphic2D*>(child)->setChildrenDirty();
+        }
+    }
+}
+
+void Graphic2D::refreshInherited() {
+    Graphic2D* parent = ParentGraphic(this->getParent());
+    if (parent) parent->refreshInherited();
+    uint32_t seen = parent ? parent->version : 0;
+    if (!this->hasFlag(GraphicFlags::INHERITED_DIRTY) && this->parentVersion == seen) return;
+    // Cleared first: inheriting may read the mask again through the render key
+    this->clearFlag(GraphicFlags::INHERITED_DIRTY);
+    this->parentVersion = seen;
+    ++this->version;
+    this->inheritFrom(parent);
 }
 
 GAPI::Common::GraphicBatchHandler &Graphic2D::getBatchHandler() {
     return RaeptorCogs::Renderer().getBackend().getRenderPipeline().getBatchHandlerAt(this->batchHandlerCursor);
 }
 
+BatchKey Graphic2D::buildRendererKey() {
+    return BatchKey(
+        this->getWritingMaskID() != 0,
+        this->getWritingMaskID() ? static_cast<uint32_t>(this->getReadingMaskID()) : 0,
+        this->getWritingMaskID() ? -this->getZIndex() : this->getZIndex(),
+        this->getWritingMaskID() ? false : this->isOpaque(),
+        /** TODO: For now program is always the same. Update when multiple programs are supported. */
+        this->getProgramID(),
+        RaeptorCogs::Renderer().getBackend().getRenderPipeline().getTextureSlot(this->getID())
+    );
+}
+
 void Graphic2D::updatePositionInRenderLists() {
     if (!this->getRenderListCount()) return;
     auto& handler = this->getBatchHandler();
-    handler.rendererKey = this->buildRendererKey();
+    RaeptorCogs::Renderer().getBackend().getRenderPipeline().getBatchKeyAt(this->batchHandlerCursor) = this->buildRendererKey();
     for (auto& renderList : this->getRenderLists()) {
         renderList->markDirty(handler);
     }
@@ -133,18 +198,20 @@ Shape &RenderableGraphic2D::getShape() const {
     return *shape;
 }
 
-void RenderableGraphic2D::rebuildGlobalColor() {
-    if (!this->isGlobalColorDirty()) {
-        return;
-    }
-    if (this->getParent() && this->getParent()->isInstanceOf<RenderableGraphic2D>()) {
-        globalColor = (((static_cast<RenderableGraphic2D*>(this->getParent()))->getGlobalColor()) * color);
+void RenderableGraphic2D::inheritFrom(Graphic2D* parent) {
+    Graphic2D::inheritFrom(parent);
+    if (parent && parent->isInstanceOf<RenderableGraphic2D>()) {
+        globalColor = static_cast<RenderableGraphic2D*>(parent)->globalColor * color;
     } else {
         globalColor = color;
     }
     this->setGlobalColorDirty(false);
 }
 
+void RenderableGraphic2D::rebuildGlobalColor() {
+    this->refreshInherited();
+}
+
 glm::vec3 RenderableGraphic2D::getGlobalColor() {
     this->rebuildGlobalColor();
     return globalColor;
@@ -153,12 +220,7 @@ glm::vec3 RenderableGraphic2D::getGlobalColor() {
 void RenderableGraphic2D::setGlobalColorDirty(bool dirty) {
     if (dirty) {
         FlagSet<RenderableGraphicFlags>::setFlag(RenderableGraphicFlags::GLOBAL_COLOR_DIRTY);
-        this->setDataDirty(true);
-        for (Node* child : this->getChildren()) {
-            if (child->isInstanceOf<RenderableGraphic2D>()) {
-                static_cast<RenderableGraphic2D*>(child)->setGlobalColorDirty(true);
-            }
-        }
+        this->setInheritedDirty();
     } else {
         FlagSet<RenderableGraphicFlags>::clearFlag(RenderableGraphicFlags::GLOBAL_COLOR_DIRTY);
     }
@@ -176,30 +238,73 @@ void RenderableGraphic2D::setParent(Node* parent) {
 #pragma endregion
 #pragma region TransformableGraphic2D
 
+namespace {
+
+glm::mat4 AffineToMatrix(const Affine2D& affine) {
+    glm::mat4 matrix(1.0f);
+    matrix[0][0] = affine.a;
+    matrix[0][1] = affine.b;
+    matrix[1][0] = affine.c;
+    matrix[1][1] = affine.d;
+    matrix[3][0] = affine.tx;
+    matrix[3][1] = affine.ty;
+    matrix[3][2] = affine.tz;
+    return matrix;
+}
+
+}
 
-glm::mat4 &TransformableGraphic2D::getLocalMatrix() {
-    return localMatrix;
+TransformableGraphic2D::TransformableGraphic2D() : transformID(Transforms().create()) {
+    FlagSet<TransformFlags>::setFlag(TransformFlags::LOCAL_MATRIX_DIRTY);
+    FlagSet<TransformFlags>::setFlag(TransformFlags::GLOBAL_MATRIX_DIRTY);
 }
 
-glm::mat4 &TransformableGraphic2D::getGlobalMatrix() {
-    return globalMatrix;
+TransformableGraphic2D::TransformableGraphic2D(const TransformableGraphic2D& other)
+    : RegisterNode<TransformableGraphic2D, RenderableGraphic2D>(other), FlagSet<TransformFlags>(other), transformID(Transforms().create()) {
+    TransformHierarchy& hierarchy = Transforms();
+    hierarchy.setComponents(transformID, hierarchy.getComponents(other.transformID));
+}
+
+TransformableGraphic2D& TransformableGraphic2D::operator=(const TransformableGraphic2D& other) {
+    if (this == &other) return *this;
+    RegisterNode<TransformableGraphic2D, RenderableGraphic2D>::operator=(other);
+    FlagSet<TransformFlags>::operator=(other);
+    TransformHierarchy& hierarchy = Transforms();
+    hierarchy.setComponents(transformID, hierarchy.getComponents(other.transformID));
+    return *this;
+}
+
+TransformableGraphic2D::~TransformableGraphic2D() {
+    TransformHierarchy& hierarchy = Transforms();
+    for (Node* child : this->getChildren()) {
+        if (child->isInstanceOf<TransformableGraphic2D>()) {
+            hierarchy.setParent(static_cast<TransformableGraphic2D*>(child)->transformID, TransformHierarchy::NO_TRANSFORM);
+        }
+    }
+    hierarchy.destroy(transformID);
+}
+
+TransformID TransformableGraphic2D::GetParentTransform(Node* parent) {
+    if (parent && parent->isInstanceOf<TransformableGraphic2D>()) {
+        return static_cast<TransformableGraphic2D*>(parent)->transformID;
+    }
+    return TransformHierarchy::NO_TRANSFORM;
+}
+
+glm::mat4 TransformableGraphic2D::getLocalMatrix() const {
+    return AffineToMatrix(ComposeLocalAffine(Transforms().getComponents(transformID)));
 }
 
 glm::mat4 TransformableGraphic2D::getModelMatrix() {
-    this->rebuildLocalMatrix();
     this->rebuildGlobalMatrix();
-    return globalMatrix;
+    return AffineToMatrix(Transforms().getGlobal(transformID));
 }
 
 void TransformableGraphic2D::setLocalMatrixDirty(bool dirty) {
     if (dirty) {
         FlagSet<TransformFlags>::setFlag(TransformFlags::LOCAL_MATRIX_DIRTY);
-        this->setDataDirty(true);
-        for (Node* child : this->getChildren()) {
-            if (child->isInstanceOf<TransformableGraphic2D>()) {
-                static_cast<TransformableGraphic2D*>(child)->setGlobalMatrixDirty(true);
-            }
-        }
+        Transforms().markDirty(transformID);
+        this->setChildrenDirty();
     } else {
         FlagSet<TransformFlags>::clearFlag(TransformFlags::LOCAL_MATRIX_DIRTY);
     }
@@ -212,12 +317,7 @@ bool TransformableGraphic2D::isLocalMatrixDirty() const {
 void TransformableGraphic2D::setGlobalMatrixDirty(bool dirty) {
     if (dirty) {
         FlagSet<TransformFlags>::setFlag(TransformFlags::GLOBAL_MATRIX_DIRTY);
-        this->setDataDirty(true);
-        for (Node* child : this->getChildren()) {
-            if (child->isInstanceOf<TransformableGraphic2D>()) {
-                static_cast<TransformableGraphic2D*>(child)->setGlobalMatrixDirty(true);
-            }
-        }
+        this->setChildrenDirty();
     } else {
         FlagSet<TransformFlags>::clearFlag(TransformFlags::GLOBAL_MATRIX_DIRTY);
     }
@@ -227,96 +327,73 @@ bool TransformableGraphic2D::isGlobalMatrixDirty() const {
     return FlagSet<TransformFlags>::hasFlag(TransformFlags::GLOBAL_MATRIX_DIRTY);
 }
 
-
-
-
-void TransformableGraphic2D::rebuildLocalMatrix() {
-    if (!this->isLocalMatrixDirty()) {
-        return;
-    }
-
-    // Rebuild the model matrix
-    localMatrix = glm::mat4(1.0f);
-    localMatrix = glm::translate(localMatrix, glm::vec3(position, 0.0f));
-    localMatrix = glm::rotate(localMatrix, rotation, glm::vec3(0.0f, 0.0f, 1.0f));
-    localMatrix = glm::scale(localMatrix, glm::vec3(size, 1.0f));
-    localMatrix = glm::scale(localMatrix, glm::vec3(scale, 1.0f));
-    localMatrix = glm::translate(localMatrix, glm::vec3(-anchor, 0.0f));
-    localMatrix[3][2] = this->getZIndex()/1000.0f; // Restore zIndex
-}
-
 void TransformableGraphic2D::rebuildGlobalMatrix() {
     if (!this->isGlobalMatrixDirty() && !this->isLocalMatrixDirty()) {
         return;
     }
-    if (this->getParent() && this->getParent()->isInstanceOf<TransformableGraphic2D>()) {
-        TransformableGraphic2D* parent = static_cast<TransformableGraphic2D*>(this->getParent());
-        glm::mat4 parentMatrix = parent->getModelMatrix();
-        parentMatrix = glm::translate(parentMatrix, glm::vec3(parent->getAnchor(), 0.0f));
-        parentMatrix = glm::scale(parentMatrix, glm::vec3(glm::vec2(1.0f) / parent->getSize(), 1.0f));
-        globalMatrix = parentMatrix * localMatrix;
-    } else {
-        globalMatrix = localMatrix;
-    }
+    // The hierarchy rebuilds every dirty subtree at once, ancestors included
+    Transforms().update();
     this->setGlobalMatrixDirty(false);
     this->setLocalMatrixDirty(false);
 }
 
 void TransformableGraphic2D::setPosition(const glm::vec2 &pos) {
-    this->position = pos;
+    Transforms().setPosition(transformID, pos);
     this->setLocalMatrixDirty(true);
 }
 
 void TransformableGraphic2D::setSize(const glm::vec2 &size) {
-    this->size = size;
+    Transforms().setSize(transformID, size);
     this->setLocalMatrixDirty(true);
 }
 
 void TransformableGraphic2D::setScale(const glm::vec2 &scale) {
-    this->scale = scale;
+    Transforms().setScale(transformID, scale);
     this->setLocalMatrixDirty(true);
 }
 
 void TransformableGraphic2D::setRotation(float angle) {
-    this->rotation = angle;
+    Transforms().setRotation(transformID, angle);
     this->setLocalMatrixDirty(true);
 }
 
 void TransformableGraphic2D::setAnchor(const glm::vec2 &anchor) {
-    this->anchor = anchor;
+    Transforms().setAnchor(transformID, anchor);
     this->setLocalMatrixDirty(true);
 }
 
 void TransformableGraphic2D::setZIndex(float z) {
     Graphic2D::setZIndex(z);
+    Transforms().setDepth(transformID, z / 1000.0f);
     this->setLocalMatrixDirty(true);
 }
 
 void TransformableGraphic2D::setParent(Node* parent) {
     RenderableGraphic2D::setParent(parent);
+    Transforms().setParent(transformID, GetParentTransform(parent));
     this->setGlobalMatrixDirty(true);
 }
 
 
 
 glm::vec2 TransformableGraphic2D::getPosition() const {
-    return position;
+    return Transforms().getComponents(transformID).position;
 }
 
 glm::vec2 TransformableGraphic2D::getSize() const {
-    return size;
+    return Transforms().getComponents(transformID).size;
 }
 
 glm::vec2 TransformableGraphic2D::getScale() const {
-    return scale;
+    return Transforms().getComponents(transformID).scale;
 }
 
 float TransformableGraphic2D::getRotation() const {
-    return rotation;
+    return Transforms().getComponents(transformID).rotation;
 }
 
 glm::vec2 TransformableGraphic2D::getAnchor() const {
-    return anchor;
+    return Transforms().getComponents(transformID).anchor;
 }
 
 #pragma endregion
@@ -1,33 +1,76 @@
 #include <RaeptorCogs/Node.hpp>
-#include <algorithm>
 
 namespace RaeptorCogs {
 
-Node::~Node() {}
+Node::Node(const Node&) {}
+
+Node& Node::operator=(const Node&) {
+    return *this;
+}
+
+Node::~Node() {
+    // Raw unlinks: the derived parts are already destroyed, no virtual call
+    if (parent) parent->unlinkChild(this);
+    Node* child = firstChild;
+    while (child) {
+        Node* next = child->nextSibling;
+        child->parent = nullptr;
+        child->previousSibling = nullptr;
+        child->nextSibling = nullptr;
+        child = next;
+    }
+}
 
 void Node::addChild(Node* child) {
-    children.push_back(child);
     child->setParent(this);
 }
 
 void Node::removeChild(Node* child) {
-    auto it = std::find(children.begin(), children.end(), child);
-    if (it != children.end()) {
-        children.erase(it);
-        child->parent = nullptr;
+    if (child->parent != this) return;
+    child->setParent(nullptr);
+}
+
+void Node::linkChild(Node* child) {
+    child->previousSibling = lastChild;
+    child->nextSibling = nullptr;
+    if (lastChild) {
+        lastChild->nextSibling = child;
+    } else {
+        firstChild = child;
     }
+    lastChild = child;
+    ++childCount;
+}
+
+void Node::unlinkChild(Node* child) {
+    if (child->previousSibling) {
+        child->previousSibling->nextSibling = child->nextSibling;
+    } else {
+        firstChild = child->nextSibling;
+    }
+    if (child->nextSibling) {
+        child->nextSibling->previousSibling = child->previousSibling;
+    } else {
+        lastChild = child->previousSibling;
+    }
+    child->previousSibling = nullptr;
+    child->nextSibling = nullptr;
+    --childCount;
 }
 
 void Node::setParent(Node* parent) {
+    // The links follow the parent pointer whoever changes it, so the lists never disagree with it
+    if (this->parent) this->parent->unlinkChild(this);
     this->parent = parent;
+    if (parent) parent->linkChild(this);
 }
 
-const std::vector<Node*>& Node::getChildren() const {
-    return children;
+Node::ChildRange Node::getChildren() const {
+    return ChildRange(this);
 }
 
 Node* Node::getParent() const {
     return this->parent;
 }
 
-}
\ No newline at end of file
+}
@@ -125,6 +125,10 @@ Singletons::Platform& Platform() {
     return RaeptorCogs::SingletonAccessor<Singletons::Platform>::get();
 }
 
+TransformHierarchy& Transforms() {
+    return RaeptorCogs::SingletonAccessor<TransformHierarchy>::get();
+}
+
 
 #pragma region Workers
 
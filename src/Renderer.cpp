@@ -70,6 +70,12 @@ void Renderer::setRenderListID(int index) {
     backend.getRenderPipeline().setRenderListID(index);
 }
 
+void Renderer::setRenderListBucketed(bool enabled, float zRange) {
+    GAPI::Common::RendererBackend& backend = this->getBackend();
+    backend.getRenderPipeline().getRenderList().setBucketed(enabled, zRange);
+    backend.getRenderPipeline().getMaskRenderList().setBucketed(enabled, zRange);
+}
+
 
 void Renderer::add(Graphic2D &graphic) {
     GAPI::Common::RendererBackend& backend = this->getBackend();
@@ -80,7 +86,7 @@ void Renderer::add(Graphic2D &graphic) {
     }
 
     BatchKey key = graphic.buildRendererKey();
-    GAPI::Common::RenderList &renderList = key.writingMask ? backend.getRenderPipeline().getMaskRenderList() : backend.getRenderPipeline().getRenderList();
+    GAPI::Common::RenderList &renderList = key.isWriting() ? backend.getRenderPipeline().getMaskRenderList() : backend.getRenderPipeline().getRenderList();
     GAPI::Common::GraphicBatchHandler &batchHandler = renderList.createHandler(key, &graphic, backend.getGraphicCore().getInstanceAllocator());
 
     backend.getGraphicCore().getInstanceUploader().markDynamicDataDirty(batchHandler.dynamicDataCursor, batchHandler.dynamicDataSize);
@@ -94,13 +100,7 @@ void Renderer::remove(Graphic2D &graphic) {
     }
     while (graphic.getRenderLists().size() > 0) {
         GAPI::Common::RenderList* renderList = graphic.getRenderLists().back();
-        for (auto [_, handler] : *renderList) {
-            if (handler.graphic == &graphic) {
-                renderList->erase(handler, backend.getGraphicCore().getInstanceAllocator());
-
-                break;
-            }
-        }
+        renderList->erase(graphic.getBatchHandler(), backend.getGraphicCore().getInstanceAllocator());
     }
 }
 
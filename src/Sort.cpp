@@ -0,0 +1,204 @@
+#include <RaeptorCogs/Sort.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#ifndef __EMSCRIPTEN__
+#include <barrier>
+#include <thread>
+#endif
+
+namespace RaeptorCogs {
+
+void RadixSorter::sortPairs(unsigned int* values, size_t count) {
+    if (count < 2) return;
+
+    keysScratch.resize(count);
+    valuesScratch.resize(count);
+
+#ifndef __EMSCRIPTEN__
+    unsigned int threads = threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    if (threads > 1 && count >= parallelThreshold) {
+        this->sortPairsParallel(values, count, static_cast<unsigned int>(std::min<size_t>(threads, count)));
+        return;
+    }
+#endif
+
+    // Build every histogram in a single read of the keys
+    std::array<std::array<size_t, DIGIT_COUNT>, PASS_COUNT> histograms{};
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t key = keys[i];
+        for (unsigned int pass = 0; pass < PASS_COUNT; ++pass) {
+            histograms[pass][(key >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1)]++;
+        }
+    }
+
+    uint64_t* srcKeys = keys.data();
+    uint64_t* dstKeys = keysScratch.data();
+    unsigned int* srcValues = values;
+    unsigned int* dstValues = valuesScratch.data();
+
+    for (unsigned int pass = 0; pass < PASS_COUNT; ++pass) {
+        auto& histogram = histograms[pass];
+        unsigned int shift = pass * DIGIT_BITS;
+
+        // Every key shares this digit, the pass would be an identity copy
+        if (histogram[(srcKeys[0] >> shift) & (DIGIT_COUNT - 1)] == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (auto& bucket : histogram) {
+            size_t bucketSize = bucket;
+            bucket = offset;
+            offset += bucketSize;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t key = srcKeys[i];
+            size_t dst = histogram[(key >> shift) & (DIGIT_COUNT - 1)]++;
+            dstKeys[dst] = key;
+            dstValues[dst] = srcValues[i];
+        }
+
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcValues, dstValues);
+    }
+
+    if (srcValues != values) {
+        std::memcpy(values, srcValues, count * sizeof(unsigned int));
+    }
+    if (srcKeys != keys.data()) {
+        std::memcpy(keys.data(), srcKeys, count * sizeof(uint64_t));
+    }
+}
+
+#ifndef __EMSCRIPTEN__
+void RadixSorter::sortPairsParallel(unsigned int* values, size_t count, unsigned int threads) {
+    using Histogram = std::array<size_t, DIGIT_COUNT>;
+
+    std::vector<std::array<Histogram, PASS_COUNT>> chunkHistograms(threads);
+    std::vector<Histogram> passHistograms(threads);
+    std::barrier sync(static_cast<std::ptrdiff_t>(threads));
+
+    uint64_t* const initialKeys = keys.data();
+    uint64_t* const scratchKeys = keysScratch.data();
+    unsigned int* const scratchValues = valuesScratch.data();
+    bool resultInScratch = false;
+
+    auto worker = [&](unsigned int thread) {
+        const size_t begin = count * thread / threads;
+        const size_t end = count * (thread + 1) / threads;
+
+        // Histograms of every digit on the initial keys, summed to find constant digits
+        auto& histograms = chunkHistograms[thread];
+        histograms = {};
+        for (size_t i = begin; i < end; ++i) {
+            uint64_t key = initialKeys[i];
+            for (unsigned int pass = 0; pass < PASS_COUNT; ++pass) {
+                histograms[pass][(key >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1)]++;
+            }
+        }
+        sync.arrive_and_wait();
+
+        std::array<bool, PASS_COUNT> skipPass{};
+        for (unsigned int pass = 0; pass < PASS_COUNT; ++pass) {
+            size_t shared = 0;
+            size_t digit = (initialKeys[0] >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1);
+            for (auto& chunk : chunkHistograms) shared += chunk[pass][digit];
+            skipPass[pass] = shared == count;
+        }
+        // Every thread must have read the initial keys before they get overwritten
+        sync.arrive_and_wait();
+
+        uint64_t* srcKeys = initialKeys;
+        uint64_t* dstKeys = scratchKeys;
+        unsigned int* srcValues = values;
+        unsigned int* dstValues = scratchValues;
+
+        for (unsigned int pass = 0; pass < PASS_COUNT; ++pass) {
+            if (skipPass[pass]) continue;
+            unsigned int shift = pass * DIGIT_BITS;
+
+            auto& local = passHistograms[thread];
+            local = {};
+            for (size_t i = begin; i < end; ++i) {
+                local[(srcKeys[i] >> shift) & (DIGIT_COUNT - 1)]++;
+            }
+            sync.arrive_and_wait();
+
+            // This chunk writes after all lower digits and after earlier chunks of the same digit
+            Histogram offsets;
+            size_t offset = 0;
+            for (unsigned int digit = 0; digit < DIGIT_COUNT; ++digit) {
+                for (unsigned int other = 0; other < threads; ++other) {
+                    if (other == thread) offsets[digit] = offset;
+                    offset += passHistograms[other][digit];
+                }
+            }
+
+            for (size_t i = begin; i < end; ++i) {
+                uint64_t key = srcKeys[i];
+                size_t dst = offsets[(key >> shift) & (DIGIT_COUNT - 1)]++;
+                dstKeys[dst] = key;
+                dstValues[dst] = srcValues[i];
+            }
+            sync.arrive_and_wait();
+
+            std::swap(srcKeys, dstKeys);
+            std::swap(srcValues, dstValues);
+        }
+
+        if (thread == 0) {
+            resultInScratch = srcValues != values;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned int thread = 1; thread < threads; ++thread) {
+        workers.emplace_back(worker, thread);
+    }
+    worker(0);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (resultInScratch) {
+        std::memcpy(values, scratchValues, count * sizeof(unsigned int));
+        std::memcpy(keys.data(), scratchKeys, count * sizeof(uint64_t));
+    }
+}
+#endif
+
+void RadixSorter::sort(std::vector<uint64_t>& sortKeys, std::vector<unsigned int>& values) {
+    std::swap(keys, sortKeys);
+    this->sortPairs(values.data(), values.size());
+    std::swap(keys, sortKeys);
+}
+
+void RadixSorter::setThreadCount(unsigned int count) {
+    threadCount = count;
+}
+
+unsigned int RadixSorter::getThreadCount() const {
+    return threadCount;
+}
+
+void RadixSorter::setParallelThreshold(size_t threshold) {
+    parallelThreshold = threshold;
+}
+
+size_t RadixSorter::getParallelThreshold() const {
+    return parallelThreshold;
+}
+
+void RadixSorter::shrink() {
+    keys.clear();
+    keys.shrink_to_fit();
+    keysScratch.clear();
+    keysScratch.shrink_to_fit();
+    valuesScratch.clear();
+    valuesScratch.shrink_to_fit();
+}
+
+}
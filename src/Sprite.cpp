@@ -8,21 +8,25 @@ bool Sprite2D::computeInstanceData(GAPI::Common::InstanceAllocator &instanceAllo
     GAPI::Common::GraphicBatchHandler &batchHandler = this->getBatchHandler();
 
     if (mode == ComputeInstanceDataMode::FORCE_REBUILD) {
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+        instanceAllocator.allocate(batchHandler, 0); // Color lives in the instance
+#else
         instanceAllocator.allocate(batchHandler, 3); // RGB color
+#endif
     }
 
     auto& staticDataBuffer = instanceAllocator.getStaticInstanceData(batchHandler.staticDataCursor);
+#ifndef RAEPTORCOGS_COMPACT_INSTANCES
     auto* dynamicDataBuffer = instanceAllocator.getDynamicInstanceData(batchHandler.dynamicDataCursor);
+#endif
 
     if (this->isDataDirty() || mode == ComputeInstanceDataMode::REBUILD_TEXTURE || mode == ComputeInstanceDataMode::FORCE_REBUILD) {
 
         // Static instance data
 
-        staticDataBuffer.model = this->getModelMatrix();
-        staticDataBuffer.uvRect = texture ? texture->getUVRect() : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
-        staticDataBuffer.type = this->isVisible() ? RENDERER_MODE_2D_SPRITE : RENDERER_MODE_DEFAULT;
-        staticDataBuffer.readingMaskID = this->getReadingMaskID();
-        staticDataBuffer.writingMaskID = this->getWritingMaskID();
+        staticDataBuffer.setModel(this->getModelMatrix());
+        staticDataBuffer.setUVRect(texture ? texture->getUVRect() : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+        staticDataBuffer.setTypeAndMasks(this->isVisible() ? RENDERER_MODE_2D_SPRITE : RENDERER_MODE_DEFAULT, this->getReadingMaskID(), this->getWritingMaskID());
         if (mode == ComputeInstanceDataMode::FORCE_REBUILD) {
             staticDataBuffer.dataOffset = batchHandler.dynamicDataCursor; // Offset into the instance data buffer
         }
@@ -30,9 +34,13 @@ bool Sprite2D::computeInstanceData(GAPI::Common::InstanceAllocator &instanceAllo
         // Dynamic instance data
 
         glm::vec3 color = this->getGlobalColor();
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+        staticDataBuffer.setColor(color);
+#else
         dynamicDataBuffer[0] = color[0];
         dynamicDataBuffer[1] = color[1];
         dynamicDataBuffer[2] = color[2];
+#endif
     }
 
     if (mode == ComputeInstanceDataMode::REBUILD_TEXTURE || this->isDataDirty()) {
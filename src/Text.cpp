@@ -35,7 +35,11 @@ bool Glyph::computeInstanceData(GAPI::Common::InstanceAllocator &instanceAllocat
     }
 
     if (mode == ComputeInstanceDataMode::FORCE_REBUILD) {
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+        instanceAllocator.allocate(batchHandler, 1); // Smoothness, color lives in the instance
+#else
         instanceAllocator.allocate(batchHandler, 4); // RGB color + smoothness
+#endif
     }
 
     auto& staticDataBuffer = instanceAllocator.getStaticInstanceData(batchHandler.staticDataCursor);
@@ -45,11 +49,9 @@ bool Glyph::computeInstanceData(GAPI::Common::InstanceAllocator &instanceAllocat
 
         // Static instance data
 
-        staticDataBuffer.model = this->getModelMatrix();
-        staticDataBuffer.uvRect = this->text->getFont()->getGlyphUVRect(character);
-        staticDataBuffer.type = this->isVisible() ? RENDERER_MODE_2D_TEXT : RENDERER_MODE_DEFAULT;
-        staticDataBuffer.readingMaskID = this->getReadingMaskID();
-        staticDataBuffer.writingMaskID = this->getWritingMaskID();
+        staticDataBuffer.setModel(this->getModelMatrix());
+        staticDataBuffer.setUVRect(this->text->getFont()->getGlyphUVRect(character));
+        staticDataBuffer.setTypeAndMasks(this->isVisible() ? RENDERER_MODE_2D_TEXT : RENDERER_MODE_DEFAULT, this->getReadingMaskID(), this->getWritingMaskID());
         if (mode == ComputeInstanceDataMode::FORCE_REBUILD) {
             staticDataBuffer.dataOffset = batchHandler.dynamicDataCursor; // Offset into the instance data buffer
         }
@@ -58,10 +60,15 @@ bool Glyph::computeInstanceData(GAPI::Common::InstanceAllocator &instanceAllocat
 
         glm::vec3 color = this->getGlobalColor();
         float smoothness = 0.2f * (NORMAL_FONT_SIZE / this->text->getTextSize());
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+        staticDataBuffer.setColor(color);
+        dynamicDataBuffer[0] = std::min(smoothness, 0.5f);
+#else
         dynamicDataBuffer[0] = color[0];
         dynamicDataBuffer[1] = color[1];
         dynamicDataBuffer[2] = color[2];
         dynamicDataBuffer[3] = std::min(smoothness, 0.5f);
+#endif
     }
 
     if (this->isDataDirty()) {
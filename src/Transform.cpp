@@ -0,0 +1,456 @@
+#include <RaeptorCogs/Transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define RAEPTORCOGS_TRANSFORM_LANES
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RAEPTORCOGS_TRANSFORM_LANES
+#endif
+
+namespace RaeptorCogs {
+
+namespace {
+
+#if defined(__AVX2__)
+
+/**
+ * @brief Eight float lanes.
+ */
+struct Lanes {
+    using Type = __m256;
+    static constexpr size_t WIDTH = 8;
+
+    static Type load(const float* array, const uint32_t* indices, bool contiguous) {
+        if (contiguous) return _mm256_loadu_ps(array + indices[0]);
+        return _mm256_i32gather_ps(array, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)), 4);
+    }
+    static Type load(const float* values) { return _mm256_loadu_ps(values); }
+    static void store(float* values, Type lanes) { _mm256_storeu_ps(values, lanes); }
+    static Type set(float value) { return _mm256_set1_ps(value); }
+    static Type mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+    static Type add(Type a, Type b) { return _mm256_add_ps(a, b); }
+    static Type negate(Type a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    static bool allZero(Type a) {
+        __m256i zero = _mm256_cmpeq_epi32(_mm256_castps_si256(a), _mm256_setzero_si256());
+        return _mm256_movemask_ps(_mm256_castsi256_ps(zero)) == 0xFF;
+    }
+};
+
+#elif defined(RAEPTORCOGS_TRANSFORM_LANES)
+
+/**
+ * @brief Four float lanes.
+ */
+struct Lanes {
+    using Type = __m128;
+    static constexpr size_t WIDTH = 4;
+
+    static Type load(const float* array, const uint32_t* indices, bool contiguous) {
+        if (contiguous) return _mm_loadu_ps(array + indices[0]);
+        return _mm_set_ps(array[indices[3]], array[indices[2]], array[indices[1]], array[indices[0]]);
+    }
+    static Type load(const float* values) { return _mm_loadu_ps(values); }
+    static void store(float* values, Type lanes) { _mm_storeu_ps(values, lanes); }
+    static Type set(float value) { return _mm_set1_ps(value); }
+    static Type mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+    static Type add(Type a, Type b) { return _mm_add_ps(a, b); }
+    static Type negate(Type a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    static bool allZero(Type a) {
+        __m128i zero = _mm_cmpeq_epi32(_mm_castps_si128(a), _mm_setzero_si128());
+        return _mm_movemask_ps(_mm_castsi128_ps(zero)) == 0xF;
+    }
+};
+
+#endif
+
+#ifdef RAEPTORCOGS_TRANSFORM_LANES
+
+/**
+ * @brief Compose the local affine transforms of one batch of Lanes::WIDTH transforms.
+ * 
+ * @note Same operations in the same order as ComposeLocalAffine, one lane per transform.
+ */
+void ComposeLaneAffines(const TransformComponentArrays& components, const uint32_t* indices, Affine2D* locals) {
+    constexpr size_t WIDTH = Lanes::WIDTH;
+    // Indices ascend, so a span of WIDTH means consecutive ones
+    bool contiguous = indices[WIDTH - 1] - indices[0] == WIDTH - 1;
+
+    Lanes::Type rotation = Lanes::load(components.rotation.data(), indices, contiguous);
+    Lanes::Type cosine = Lanes::set(1.0f);
+    Lanes::Type sine = Lanes::set(0.0f);
+    if (!Lanes::allZero(rotation)) {
+        // No vector sine gives the libm results, which the glm path used
+        float angles[WIDTH], cosines[WIDTH], sines[WIDTH];
+        Lanes::store(angles, rotation);
+        for (size_t lane = 0; lane < WIDTH; ++lane) {
+            cosines[lane] = std::cos(angles[lane]);
+            sines[lane] = std::sin(angles[lane]);
+        }
+        cosine = Lanes::load(cosines);
+        sine = Lanes::load(sines);
+    }
+
+    Lanes::Type sizeX = Lanes::load(components.sizeX.data(), indices, contiguous);
+    Lanes::Type sizeY = Lanes::load(components.sizeY.data(), indices, contiguous);
+    Lanes::Type scaleX = Lanes::load(components.scaleX.data(), indices, contiguous);
+    Lanes::Type scaleY = Lanes::load(components.scaleY.data(), indices, contiguous);
+    Lanes::Type anchorX = Lanes::negate(Lanes::load(components.anchorX.data(), indices, contiguous));
+    Lanes::Type anchorY = Lanes::negate(Lanes::load(components.anchorY.data(), indices, contiguous));
+    Lanes::Type positionX = Lanes::load(components.positionX.data(), indices, contiguous);
+    Lanes::Type positionY = Lanes::load(components.positionY.data(), indices, contiguous);
+
+    Lanes::Type a = Lanes::mul(Lanes::mul(cosine, sizeX), scaleX);
+    Lanes::Type b = Lanes::mul(Lanes::mul(sine, sizeX), scaleX);
+    Lanes::Type c = Lanes::mul(Lanes::mul(Lanes::negate(sine), sizeY), scaleY);
+    Lanes::Type d = Lanes::mul(Lanes::mul(cosine, sizeY), scaleY);
+    Lanes::Type tx = Lanes::add(Lanes::add(Lanes::mul(a, anchorX), Lanes::mul(c, anchorY)), positionX);
+    Lanes::Type ty = Lanes::add(Lanes::add(Lanes::mul(b, anchorX), Lanes::mul(d, anchorY)), positionY);
+
+    float outA[WIDTH], outB[WIDTH], outC[WIDTH], outD[WIDTH], outTX[WIDTH], outTY[WIDTH];
+    Lanes::store(outA, a);
+    Lanes::store(outB, b);
+    Lanes::store(outC, c);
+    Lanes::store(outD, d);
+    Lanes::store(outTX, tx);
+    Lanes::store(outTY, ty);
+    for (size_t lane = 0; lane < WIDTH; ++lane) {
+        Affine2D& local = locals[indices[lane]];
+        local.a = outA[lane];
+        local.b = outB[lane];
+        local.c = outC[lane];
+        local.d = outD[lane];
+        local.tx = outTX[lane];
+        local.ty = outTY[lane];
+        local.tz = components.depth[indices[lane]];
+    }
+}
+
+#endif
+
+}
+
+void TransformComponentArrays::push(const TransformComponents& components) {
+    positionX.push_back(components.position.x);
+    positionY.push_back(components.position.y);
+    sizeX.push_back(components.size.x);
+    sizeY.push_back(components.size.y);
+    scaleX.push_back(components.scale.x);
+    scaleY.push_back(components.scale.y);
+    rotation.push_back(components.rotation);
+    anchorX.push_back(components.anchor.x);
+    anchorY.push_back(components.anchor.y);
+    depth.push_back(components.depth);
+}
+
+void TransformComponentArrays::set(size_t index, const TransformComponents& components) {
+    positionX[index] = components.position.x;
+    positionY[index] = components.position.y;
+    sizeX[index] = components.size.x;
+    sizeY[index] = components.size.y;
+    scaleX[index] = components.scale.x;
+    scaleY[index] = components.scale.y;
+    rotation[index] = components.rotation;
+    anchorX[index] = components.anchor.x;
+    anchorY[index] = components.anchor.y;
+    depth[index] = components.depth;
+}
+
+TransformComponents TransformComponentArrays::get(size_t index) const {
+    TransformComponents components;
+    components.position = glm::vec2(positionX[index], positionY[index]);
+    components.size = glm::vec2(sizeX[index], sizeY[index]);
+    components.scale = glm::vec2(scaleX[index], scaleY[index]);
+    components.rotation = rotation[index];
+    components.anchor = glm::vec2(anchorX[index], anchorY[index]);
+    components.depth = depth[index];
+    return components;
+}
+
+Affine2D ComposeLocalAffine(const TransformComponents& components) {
+    float cosine = std::cos(components.rotation);
+    float sine = std::sin(components.rotation);
+
+    Affine2D local;
+    local.a = cosine * components.size.x * components.scale.x;
+    local.b = sine * components.size.x * components.scale.x;
+    local.c = -sine * components.size.y * components.scale.y;
+    local.d = cosine * components.size.y * components.scale.y;
+    local.tx = local.a * -components.anchor.x + local.c * -components.anchor.y + components.position.x;
+    local.ty = local.b * -components.anchor.x + local.d * -components.anchor.y + components.position.y;
+    local.tz = components.depth;
+    return local;
+}
+
+void ComposeLocalAffines(const TransformComponentArrays& components, const uint32_t* indices, size_t count, Affine2D* locals) {
+    size_t index = 0;
+#ifdef RAEPTORCOGS_TRANSFORM_LANES
+    for (; index + Lanes::WIDTH <= count; index += Lanes::WIDTH) {
+        ComposeLaneAffines(components, indices + index, locals);
+    }
+#endif
+    for (; index < count; ++index) {
+        locals[indices[index]] = ComposeLocalAffine(components.get(indices[index]));
+    }
+}
+
+Affine2D ComposeChildAffine(const Affine2D& parentGlobal, const glm::vec2& parentSize, const glm::vec2& parentAnchor, const Affine2D& local) {
+    // Space of the children: anchored on the parent, in units of its size
+    float inverseX = 1.0f / parentSize.x;
+    float inverseY = 1.0f / parentSize.y;
+    float a = parentGlobal.a * inverseX;
+    float b = parentGlobal.b * inverseX;
+    float c = parentGlobal.c * inverseY;
+    float d = parentGlobal.d * inverseY;
+    float tx = parentGlobal.tx + parentGlobal.a * parentAnchor.x + parentGlobal.c * parentAnchor.y;
+    float ty = parentGlobal.ty + parentGlobal.b * parentAnchor.x + parentGlobal.d * parentAnchor.y;
+
+    Affine2D global;
+    global.a = a * local.a + c * local.b;
+    global.b = b * local.a + d * local.b;
+    global.c = a * local.c + c * local.d;
+    global.d = b * local.c + d * local.d;
+    global.tx = a * local.tx + c * local.ty + tx;
+    global.ty = b * local.tx + d * local.ty + ty;
+    global.tz = parentGlobal.tz + local.tz;
+    return global;
+}
+
+TransformID TransformHierarchy::create() {
+    TransformID id;
+    if (!freeTransforms.empty()) {
+        id = freeTransforms.back();
+        freeTransforms.pop_back();
+    } else {
+        id = static_cast<TransformID>(slots.size());
+        slots.push_back(NO_SLOT);
+    }
+
+    // A root fits any slot, so free ones are reused first
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        components.set(slot, TransformComponents());
+        parents[slot] = NO_SLOT;
+        owners[slot] = id;
+    } else {
+        slot = static_cast<uint32_t>(components.size());
+        components.push(TransformComponents());
+        locals.emplace_back();
+        globals.emplace_back();
+        parents.push_back(NO_SLOT);
+        dirty.push_back(0);
+        stamps.push_back(0);
+        owners.push_back(id);
+    }
+    slots[id] = slot;
+    this->markSlotDirty(slot);
+    return id;
+}
+
+void TransformHierarchy::destroy(TransformID id) {
+    uint32_t slot = this->getSlot(id);
+    if (slot == NO_SLOT) return;
+    owners[slot] = NO_TRANSFORM;
+    parents[slot] = NO_SLOT;
+    dirty[slot] = 0;
+    slots[id] = NO_SLOT;
+    freeSlots.push_back(slot);
+    freeTransforms.push_back(id);
+    // Mostly empty arrays slow the update pass down, the sort drops the free slots
+    if (freeSlots.size() * 2 > components.size()) orderDirty = true;
+}
+
+void TransformHierarchy::setParent(TransformID id, TransformID parent) {
+    uint32_t slot = slots[id];
+    uint32_t parentSlot = parent == NO_TRANSFORM ? NO_SLOT : slots[parent];
+    parents[slot] = parentSlot;
+    if (parentSlot != NO_SLOT && parentSlot > slot) orderDirty = true;
+    this->markSlotDirty(slot);
+}
+
+TransformID TransformHierarchy::getParent(TransformID id) const {
+    uint32_t parentSlot = parents[slots[id]];
+    return parentSlot == NO_SLOT ? NO_TRANSFORM : owners[parentSlot];
+}
+
+void TransformHierarchy::setComponents(TransformID id, const TransformComponents& components) {
+    this->components.set(slots[id], components);
+    this->markSlotDirty(slots[id]);
+}
+
+void TransformHierarchy::setPosition(TransformID id, const glm::vec2& position) {
+    uint32_t slot = slots[id];
+    components.positionX[slot] = position.x;
+    components.positionY[slot] = position.y;
+    this->markSlotDirty(slot);
+}
+
+void TransformHierarchy::setSize(TransformID id, const glm::vec2& size) {
+    uint32_t slot = slots[id];
+    components.sizeX[slot] = size.x;
+    components.sizeY[slot] = size.y;
+    this->markSlotDirty(slot);
+}
+
+void TransformHierarchy::setScale(TransformID id, const glm::vec2& scale) {
+    uint32_t slot = slots[id];
+    components.scaleX[slot] = scale.x;
+    components.scaleY[slot] = scale.y;
+    this->markSlotDirty(slot);
+}
+
+void TransformHierarchy::setRotation(TransformID id, float rotation) {
+    uint32_t slot = slots[id];
+    components.rotation[slot] = rotation;
+    this->markSlotDirty(slot);
+}
+
+void TransformHierarchy::setAnchor(TransformID id, const glm::vec2& anchor) {
+    uint32_t slot = slots[id];
+    components.anchorX[slot] = anchor.x;
+    components.anchorY[slot] = anchor.y;
+    this->markSlotDirty(slot);
+}
+
+void TransformHierarchy::setDepth(TransformID id, float depth) {
+    uint32_t slot = slots[id];
+    components.depth[slot] = depth;
+    this->markSlotDirty(slot);
+}
+
+void TransformHierarchy::markDirty(TransformID id) {
+    this->markSlotDirty(slots[id]);
+}
+
+void TransformHierarchy::markSlotDirty(uint32_t slot) {
+    dirty[slot] = 1;
+    firstDirty = std::min<size_t>(firstDirty, slot);
+}
+
+void TransformHierarchy::sortSlots() {
+    size_t count = components.size();
+
+    // Depth of each slot, walking up to the first ancestor of known depth
+    std::vector<uint32_t> depths(count, NO_SLOT);
+    std::vector<uint32_t> path;
+    uint32_t maxDepth = 0;
+    for (uint32_t slot = 0; slot < count; ++slot) {
+        if (owners[slot] == NO_TRANSFORM || depths[slot] != NO_SLOT) continue;
+        uint32_t ancestor = slot;
+        while (ancestor != NO_SLOT && depths[ancestor] == NO_SLOT) {
+            path.push_back(ancestor);
+            ancestor = parents[ancestor];
+        }
+        uint32_t depth = ancestor == NO_SLOT ? 0 : depths[ancestor] + 1;
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            depths[*it] = depth++;
+        }
+        maxDepth = std::max(maxDepth, depth - 1);
+        path.clear();
+    }
+
+    // Counting sort on the depth
+    std::vector<uint32_t> offsets(static_cast<size_t>(maxDepth) + 2, 0);
+    for (uint32_t slot = 0; slot < count; ++slot) {
+        if (owners[slot] != NO_TRANSFORM) ++offsets[depths[slot] + 1];
+    }
+    for (size_t depth = 1; depth < offsets.size(); ++depth) offsets[depth] += offsets[depth - 1];
+    std::vector<uint32_t> remap(count, NO_SLOT);
+    for (uint32_t slot = 0; slot < count; ++slot) {
+        if (owners[slot] != NO_TRANSFORM) remap[slot] = offsets[depths[slot]]++;
+    }
+
+    size_t alive = count - freeSlots.size();
+    TransformComponentArrays sortedComponents;
+    for (std::vector<float> TransformComponentArrays::* field : {
+            &TransformComponentArrays::positionX, &TransformComponentArrays::positionY,
+            &TransformComponentArrays::sizeX, &TransformComponentArrays::sizeY,
+            &TransformComponentArrays::scaleX, &TransformComponentArrays::scaleY,
+            &TransformComponentArrays::rotation,
+            &TransformComponentArrays::anchorX, &TransformComponentArrays::anchorY,
+            &TransformComponentArrays::depth}) {
+        std::vector<float>& sorted = sortedComponents.*field;
+        const std::vector<float>& source = components.*field;
+        sorted.resize(alive);
+        for (uint32_t slot = 0; slot < count; ++slot) {
+            if (remap[slot] != NO_SLOT) sorted[remap[slot]] = source[slot];
+        }
+    }
+    std::vector<Affine2D> sortedLocals(alive);
+    std::vector<Affine2D> sortedGlobals(alive);
+    std::vector<uint32_t> sortedParents(alive);
+    std::vector<uint8_t> sortedDirty(alive);
+    std::vector<TransformID> sortedOwners(alive);
+    firstDirty = SIZE_MAX;
+    for (uint32_t slot = 0; slot < count; ++slot) {
+        uint32_t target = remap[slot];
+        if (target == NO_SLOT) continue;
+        sortedLocals[target] = locals[slot];
+        sortedGlobals[target] = globals[slot];
+        sortedParents[target] = parents[slot] == NO_SLOT ? NO_SLOT : remap[parents[slot]];
+        sortedDirty[target] = dirty[slot];
+        sortedOwners[target] = owners[slot];
+        slots[owners[slot]] = target;
+        if (dirty[slot]) firstDirty = std::min<size_t>(firstDirty, target);
+    }
+    components = std::move(sortedComponents);
+    locals = std::move(sortedLocals);
+    globals = std::move(sortedGlobals);
+    parents = std::move(sortedParents);
+    dirty = std::move(sortedDirty);
+    owners = std::move(sortedOwners);
+    stamps.assign(alive, 0);
+    pass = 0;
+    freeSlots.clear();
+    orderDirty = false;
+}
+
+void TransformHierarchy::update() {
+    if (orderDirty) this->sortSlots();
+    if (firstDirty == SIZE_MAX) return;
+    if (++pass == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        pass = 1;
+    }
+
+    // Only the changed components need their sine and cosine again
+    size_t count = components.size();
+    dirtySlots.resize(count - firstDirty);
+    size_t dirtyCount = 0;
+    for (size_t slot = firstDirty; slot < count; ++slot) {
+        // Free slots are never dirty; branchless, as dirty slots are often scattered
+        dirtySlots[dirtyCount] = static_cast<uint32_t>(slot);
+        dirtyCount += dirty[slot];
+    }
+    ComposeLocalAffines(components, dirtySlots.data(), dirtyCount, locals.data());
+
+    // Parents come first: a child sees whether its parent was rebuilt in this pass
+    for (size_t slot = firstDirty; slot < count; ++slot) {
+        uint32_t parent = parents[slot];
+        bool parentMoved = parent != NO_SLOT && stamps[parent] == pass;
+        if (!dirty[slot] && !parentMoved) continue;
+        dirty[slot] = 0;
+        if (owners[slot] == NO_TRANSFORM) continue;
+        const Affine2D& local = locals[slot];
+        if (parent == NO_SLOT) {
+            globals[slot] = local;
+        } else {
+            glm::vec2 parentSize(components.sizeX[parent], components.sizeY[parent]);
+            glm::vec2 parentAnchor(components.anchorX[parent], components.anchorY[parent]);
+            globals[slot] = ComposeChildAffine(globals[parent], parentSize, parentAnchor, local);
+        }
+        stamps[slot] = pass;
+    }
+    firstDirty = SIZE_MAX;
+}
+
+const Affine2D& TransformHierarchy::getGlobal(TransformID id) {
+    if (this->needsUpdate()) this->update();
+    return globals[slots[id]];
+}
+
+}
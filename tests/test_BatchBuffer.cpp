@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include <RaeptorCogs/GAPI/Common/Core/BatchBuffer.hpp>
+
+using namespace RaeptorCogs;
+using namespace RaeptorCogs::GAPI::Common;
+
+namespace {
+
+BatchKey keyWithZ(float z) {
+    return BatchKey(false, 0, z, false, 0, 1);
+}
+
+}
+
+TEST(BatchBufferTest, KeysFollowTheirHandler) {
+    BatchBuffer batch;
+    EXPECT_TRUE(batch.empty());
+    for (int i = 0; i < 4; ++i) {
+        auto& handler = batch.emplace_back(keyWithZ(static_cast<float>(i)), nullptr);
+        handler.staticDataCursor = static_cast<unsigned int>(i);
+    }
+    ASSERT_EQ(batch.size(), 4);
+    EXPECT_EQ(batch.indexOf(batch[2]), 2);
+    EXPECT_EQ(batch.getKeys()[3], keyWithZ(3.0f));
+
+    batch.move(3, 1);
+    EXPECT_EQ(batch[1].staticDataCursor, 3);
+    EXPECT_EQ(batch.getKey(1), keyWithZ(3.0f));
+
+    batch.pop_back();
+    batch.truncate(2);
+    ASSERT_EQ(batch.size(), 2);
+    EXPECT_EQ(batch.getKey(0), keyWithZ(0.0f));
+    EXPECT_EQ(batch.getKey(1), keyWithZ(3.0f));
+
+    batch.truncate(10); // Never grows
+    EXPECT_EQ(batch.size(), 2);
+    batch.clear();
+    EXPECT_TRUE(batch.empty());
+}
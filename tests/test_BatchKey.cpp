@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <RaeptorCogs/GAPI/Common/Core/GraphicHandler.hpp>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+
+using namespace RaeptorCogs;
+
+TEST(BatchKeyTest, FieldsRoundTrip) {
+    BatchKey key(true, 1234, -3.75f, false, 5, 0xBEEF);
+
+    EXPECT_TRUE(key.isWriting());
+    EXPECT_EQ(key.getReadingMask(), 1234);
+    EXPECT_FLOAT_EQ(key.getZIndex(), -3.75f);
+    EXPECT_FALSE(key.isOpaque());
+    EXPECT_EQ(key.getProgramID(), 5);
+    EXPECT_EQ(key.getTextureSlot(), 0xBEEF);
+}
+
+TEST(BatchKeyTest, TextureSlotsDoNotAlias) {
+    BatchKeySlots slots(BatchKey::TEXTURE_BITS);
+    // Same low bits, would share the field if the IDs went in as is
+    uint32_t first = slots.get(0x00001);
+    uint32_t second = slots.get(0x10001);
+
+    EXPECT_NE(first, second);
+    EXPECT_EQ(slots.get(0x00001), first);
+    EXPECT_EQ(slots.size(), 2);
+    EXPECT_FALSE(BatchKey(false, 0, 0.0f, false, 0, first).matches(BatchKey(false, 0, 0.0f, false, 0, second), BatchKey::TEXTURE_FIELD));
+}
+
+TEST(BatchKeyTest, TextureSlotsThrowWhenFull) {
+    BatchKeySlots slots(2);
+    for (uint32_t id = 0; id < 4; ++id) EXPECT_EQ(slots.get(id * 0x10000), id);
+
+    EXPECT_THROW(slots.get(4 * 0x10000), std::runtime_error);
+    // Known IDs keep their slot
+    EXPECT_EQ(slots.get(3 * 0x10000), 3);
+    EXPECT_EQ(slots.size(), 4);
+}
+
+TEST(BatchKeyTest, FractionalZIndexIsOrdered) {
+    EXPECT_LT(BatchKey(false, 0, 0.1f, false, 0, 1), BatchKey(false, 0, 0.9f, false, 0, 1));
+    EXPECT_LT(BatchKey(false, 0, -0.9f, false, 0, 1), BatchKey(false, 0, -0.1f, false, 0, 1));
+    EXPECT_LT(BatchKey(false, 0, -0.1f, false, 0, 1), BatchKey(false, 0, 0.1f, false, 0, 1));
+    EXPECT_NE(BatchKey(false, 0, 0.1f, false, 0, 1), BatchKey(false, 0, 0.9f, false, 0, 1));
+}
+
+TEST(BatchKeyTest, NegativeZeroEqualsZero) {
+    EXPECT_EQ(BatchKey(false, 0, -0.0f, false, 0, 1), BatchKey(false, 0, 0.0f, false, 0, 1));
+}
+
+TEST(BatchKeyTest, ZIndexEncodingMatchesFloatOrder) {
+    std::vector<float> values = {
+        -std::numeric_limits<float>::infinity(), -1e30f, -1000.5f, -1.0f, -std::numeric_limits<float>::denorm_min(),
+        0.0f, std::numeric_limits<float>::denorm_min(), 1e-6f, 0.5f, 1.0f, 1000.5f, 1e30f,
+        std::numeric_limits<float>::infinity()
+    };
+    for (size_t i = 1; i < values.size(); ++i) {
+        EXPECT_LT(BatchKey::EncodeZIndex(values[i - 1]), BatchKey::EncodeZIndex(values[i]));
+    }
+    for (float value : values) {
+        EXPECT_EQ(BatchKey::DecodeZIndex(BatchKey::EncodeZIndex(value)), value);
+    }
+}
+
+TEST(BatchKeyTest, OrderingMatchesFieldPriority) {
+    std::mt19937 rng(2025);
+    std::uniform_real_distribution<float> z(-100.0f, 100.0f);
+    std::uniform_int_distribution<uint32_t> mask(0, 2047);
+    std::uniform_int_distribution<uint32_t> program(0, 7);
+    std::uniform_int_distribution<uint32_t> texture(0, 0xFFFF);
+    std::uniform_int_distribution<int> coin(0, 1);
+
+    std::vector<BatchKey> keys;
+    for (int i = 0; i < 2000; ++i) {
+        bool writing = coin(rng);
+        // Coarse z values so that lower priority fields get compared too
+        keys.emplace_back(writing, writing ? mask(rng) % 4 : 0, static_cast<float>(static_cast<int>(z(rng)) / 50), coin(rng), program(rng), texture(rng) % 8);
+    }
+
+    auto fields = [](const BatchKey& key) {
+        return std::make_tuple(key.isWriting(), key.getReadingMask(), key.getZIndex(), key.isOpaque(), key.getProgramID(), key.getTextureSlot());
+    };
+    for (size_t i = 0; i < keys.size(); ++i) {
+        for (size_t j = i + 1; j < std::min(keys.size(), i + 50); ++j) {
+            EXPECT_EQ(keys[i] < keys[j], fields(keys[i]) < fields(keys[j]));
+            EXPECT_EQ(keys[i] == keys[j], fields(keys[i]) == fields(keys[j]));
+        }
+    }
+}
+
+TEST(BatchKeyTest, MatchesSelectedFields) {
+    BatchKey a(true, 3, 1.0f, false, 0, 7);
+    BatchKey b(false, 3, 2.0f, true, 0, 7);
+
+    EXPECT_TRUE(a.matches(b, BatchKey::TEXTURE_FIELD | BatchKey::READING_MASK_FIELD));
+    EXPECT_FALSE(a.matches(b, BatchKey::TEXTURE_FIELD | BatchKey::WRITING_FIELD));
+    EXPECT_FALSE(a.matches(b, BatchKey::ZINDEX_FIELD));
+}
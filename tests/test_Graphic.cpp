@@ -151,3 +151,79 @@ TEST(GraphicFlagSetTest, IndependentFlagSets) {
     EXPECT_FALSE(flags2.hasFlag(GraphicFlags::DATA_DIRTY));
     EXPECT_TRUE(flags2.hasFlag(GraphicFlags::NO_BATCHING));
 }
+
+namespace {
+
+// Concrete graphic, never added to a renderer
+class TestGraphic : public RenderableGraphic2D {
+    public:
+        void bind() const override {}
+        uint32_t getID() const override { return 0; }
+        bool isOpaque() const override { return true; }
+};
+
+}
+
+TEST(GraphicInheritanceTest, ChildrenPullTheParentColorWhenRead) {
+    TestGraphic parent, child, grandchild;
+    parent.addChild(&child);
+    child.addChild(&grandchild);
+    child.setColor(glm::vec3(0.5f, 1.0f, 1.0f));
+    parent.setColor(glm::vec3(1.0f, 0.5f, 1.0f));
+    EXPECT_FLOAT_EQ(grandchild.getGlobalColor().x, 0.5f);
+    EXPECT_FLOAT_EQ(grandchild.getGlobalColor().y, 0.5f);
+
+    // The setter leaves the descendants alone, they see the new version when read
+    uint32_t version = grandchild.getVersion();
+    parent.setColor(glm::vec3(0.25f, 1.0f, 1.0f));
+    EXPECT_EQ(grandchild.getVersion(), version);
+    EXPECT_FLOAT_EQ(grandchild.getGlobalColor().x, 0.125f);
+    EXPECT_NE(grandchild.getVersion(), version);
+
+    // Nothing changed since, nothing is pulled
+    version = grandchild.getVersion();
+    grandchild.getGlobalColor();
+    EXPECT_EQ(grandchild.getVersion(), version);
+}
+
+TEST(GraphicInheritanceTest, ChildrenPullTheParentMaskWhenRead) {
+    TestGraphic parent, child, grandchild;
+    parent.addChild(&child);
+    child.addChild(&grandchild);
+    parent.setWritingMaskID(3);
+    EXPECT_EQ(grandchild.getReadingMaskID(), 3);
+
+    child.setWritingMaskID(5);
+    EXPECT_EQ(child.getReadingMaskID(), 3);
+    EXPECT_EQ(grandchild.getReadingMaskID(), 5);
+
+    // A mask of its own is kept
+    grandchild.setReadingMaskID(7);
+    parent.setWritingMaskID(4);
+    EXPECT_EQ(child.getReadingMaskID(), 4);
+    EXPECT_EQ(grandchild.getReadingMaskID(), 7);
+}
+
+TEST(GraphicInheritanceTest, ChildrenOutsideRenderListsAreMarkedRightAway) {
+    TestGraphic parent, child, grandchild;
+    parent.addChild(&child);
+    child.addChild(&grandchild);
+    child.setDataDirty(false);
+    grandchild.setDataDirty(false);
+
+    parent.setColor(glm::vec3(0.5f, 0.5f, 0.5f));
+    EXPECT_TRUE(child.isDataDirty());
+    EXPECT_TRUE(grandchild.isDataDirty());
+    EXPECT_FALSE(parent.FlagSet<GraphicFlags>::hasFlag(GraphicFlags::CHILDREN_DIRTY));
+}
+
+TEST(GraphicMaskTest, OutOfRangeMaskIDsAreRejected) {
+    TestGraphic graphic;
+    graphic.setWritingMaskID(Graphic2D::MAX_MASK_ID);
+    graphic.setReadingMaskID(Graphic2D::MAX_MASK_ID);
+
+    EXPECT_THROW(graphic.setWritingMaskID(Graphic2D::MAX_MASK_ID + 1), std::runtime_error);
+    EXPECT_THROW(graphic.setReadingMaskID(-1), std::runtime_error);
+    EXPECT_EQ(graphic.getWritingMaskID(), Graphic2D::MAX_MASK_ID);
+    EXPECT_EQ(graphic.getReadingMaskID(), Graphic2D::MAX_MASK_ID);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <RaeptorCogs/GAPI/Common/Core/InstanceData.hpp>
+
+using namespace RaeptorCogs;
+using namespace RaeptorCogs::GAPI::Common;
+
+TEST(InstanceDataTest, PackUnorm16x2MatchesGLSLLayout) {
+    EXPECT_EQ(PackUnorm16x2(0.0f, 0.0f), 0u);
+    EXPECT_EQ(PackUnorm16x2(1.0f, 0.0f), 0x0000FFFFu);
+    EXPECT_EQ(PackUnorm16x2(0.0f, 1.0f), 0xFFFF0000u);
+    // Out of range values are clamped like unpackUnorm2x16 expects
+    EXPECT_EQ(PackUnorm16x2(-0.5f, 2.0f), 0xFFFF0000u);
+
+    // Half a texel of an 8K atlas survives the round trip
+    float uv = 1234.0f / 8192.0f;
+    float unpacked = static_cast<float>(PackUnorm16x2(uv, 0.0f) & 0xFFFFu) / 65535.0f;
+    EXPECT_NEAR(unpacked, uv, 0.5f / 8192.0f);
+}
+
+TEST(InstanceDataTest, PackUnorm8x4MatchesGLSLLayout) {
+    EXPECT_EQ(PackUnorm8x4(1.0f, 0.0f, 0.0f, 1.0f), 0xFF0000FFu);
+    EXPECT_EQ(PackUnorm8x4(0.0f, 1.0f, 0.0f, 0.0f), 0x0000FF00u);
+    EXPECT_EQ(PackUnorm8x4(0.5f, 0.5f, 0.5f, 0.5f), 0x80808080u);
+}
+
+TEST(InstanceDataTest, PackTypeAndMasksRoundTrip) {
+    uint32_t packed = PackTypeAndMasks(2, 17, COMPACT_MAX_MASK_ID);
+    EXPECT_EQ(packed & 0xFFu, 2u);
+    EXPECT_EQ((packed >> 8) & 0xFFFu, 17u);
+    EXPECT_EQ(packed >> 20, static_cast<uint32_t>(COMPACT_MAX_MASK_ID));
+}
+
+TEST(InstanceDataTest, PackTypeAndMasksRejectsOverflow) {
+    // Would wrap to mask 0 and 1 otherwise
+    EXPECT_THROW(PackTypeAndMasks(2, COMPACT_MAX_MASK_ID + 1, 0), std::runtime_error);
+    EXPECT_THROW(PackTypeAndMasks(2, 0, COMPACT_MAX_MASK_ID + 2), std::runtime_error);
+    EXPECT_THROW(PackTypeAndMasks(2, -1, 0), std::runtime_error);
+}
+
+TEST(InstanceUploaderTest, BufferCapacityGrowsAndShrinksGeometrically) {
+    constexpr size_t MIN = InstanceUploader::MIN_BUFFER_CAPACITY;
+    EXPECT_EQ(InstanceUploader::GetBufferCapacity(0, 0), MIN);
+    EXPECT_EQ(InstanceUploader::GetBufferCapacity(0, 3 * MIN), MIN * 4);
+    EXPECT_EQ(InstanceUploader::GetBufferCapacity(MIN * 4, MIN * 4 + 1), MIN * 8);
+
+    // Trimmed under a quarter of the capacity, the buffer follows
+    EXPECT_EQ(InstanceUploader::GetBufferCapacity(MIN * 8, MIN * 2), MIN * 8);
+    EXPECT_EQ(InstanceUploader::GetBufferCapacity(MIN * 8, MIN * 2 - 1), MIN * 4);
+    EXPECT_EQ(InstanceUploader::GetBufferCapacity(MIN * 64, 10), MIN);
+}
+
+#ifdef RAEPTORCOGS_COMPACT_INSTANCES
+TEST(InstanceDataTest, CompactLayoutIsHalfTheFullOne) {
+    EXPECT_EQ(sizeof(StaticInstanceData), 48);
+    EXPECT_EQ(alignof(StaticInstanceData), 16);
+}
+#endif
+
+namespace {
+
+GraphicBatchHandler makeHandler() {
+    return GraphicBatchHandler(nullptr);
+}
+
+}
+
+TEST(InstanceAllocatorTest, DefragmentationMovesDataFrontAndTrims) {
+    InstanceData data;
+    InstanceAllocator allocator(data);
+    std::vector<GraphicBatchHandler> handlers(4, makeHandler());
+    for (auto& handler : handlers) allocator.allocate(handler, 4);
+    for (size_t i = 0; i < 4; ++i) allocator.getDynamicInstanceData(handlers[3].dynamicDataCursor)[i] = static_cast<float>(i + 1);
+    allocator.getStaticInstanceData(handlers[3].staticDataCursor).dataOffset = handlers[3].dynamicDataCursor;
+
+    allocator.free(handlers[0]);
+    allocator.free(handlers[1]);
+    EXPECT_EQ(handlers[0].dynamicDataSize, 0);
+    ASSERT_TRUE(allocator.hasFreeStaticData());
+
+    // Static slot 3 moves into the hole left in front
+    ASSERT_TRUE(allocator.moveStaticDataFront(handlers[3]));
+    EXPECT_EQ(handlers[3].staticDataCursor, 0);
+
+    ASSERT_TRUE(allocator.moveDynamicDataFront(handlers[3]));
+    EXPECT_EQ(handlers[3].dynamicDataCursor, 0);
+    EXPECT_EQ(allocator.getStaticInstanceData(0).dataOffset, 0);
+    EXPECT_EQ(allocator.getDynamicInstanceData(0)[3], 4.0f);
+
+    allocator.trim();
+    EXPECT_EQ(allocator.getStaticDataSize(), 3);
+    EXPECT_EQ(data.getDynamic().size(), 12);
+
+    // Nothing further front to move into
+    ASSERT_TRUE(allocator.moveStaticDataFront(handlers[2]));
+    EXPECT_EQ(handlers[2].staticDataCursor, 1);
+    EXPECT_FALSE(allocator.moveStaticDataFront(handlers[2]));
+}
@@ -1,11 +1,18 @@
 #include <gtest/gtest.h>
 #include <RaeptorCogs/Node.hpp>
+#include <memory>
+#include <vector>
 
 namespace RaeptorCogs {
 
 // Test classes
 class TestNode : public RegisterNode<TestNode, Node> {};
 class DerivedTestNode : public RegisterNode<DerivedTestNode, TestNode> {};
+// Exposes setParent, as an override calling it directly would
+class ReparentingTestNode : public RegisterNode<ReparentingTestNode, Node> {
+    public:
+        using Node::setParent;
+};
 
 } // namespace RaeptorCogs
 
@@ -86,4 +93,125 @@ TEST(NodeTest, DerivedNodeHierarchy) {
     
     delete root;
     delete derived;
-}
\ No newline at end of file
+}
+
+TEST(NodeTest, ClassMaskIsSharedPerClass) {
+    TestNode first;
+    TestNode second;
+    DerivedTestNode derived;
+
+    // One mask per class, built once
+    EXPECT_EQ(&first.getClassMask(), &second.getClassMask());
+    EXPECT_NE(&first.getClassMask(), &derived.getClassMask());
+    EXPECT_FALSE(first.isInstanceOf<DerivedTestNode>());
+
+    BitArray classIds = derived.getClassIds();
+    EXPECT_TRUE(classIds.test(Node::getClassId<Node>()));
+    EXPECT_TRUE(classIds.test(Node::getClassId<TestNode>()));
+    EXPECT_TRUE(classIds.test(Node::getClassId<DerivedTestNode>()));
+}
+
+TEST(NodeTest, RemovingKeepsSiblingOrder) {
+    Node root;
+    TestNode children[4];
+    for (TestNode& child : children) root.addChild(&child);
+
+    root.removeChild(&children[1]);
+    root.removeChild(&children[3]);
+    ASSERT_EQ(root.getChildren().size(), 2);
+    EXPECT_EQ(root.getChildren()[0], &children[0]);
+    EXPECT_EQ(root.getChildren()[1], &children[2]);
+
+    // Not a child anymore, nothing happens
+    root.removeChild(&children[1]);
+    EXPECT_EQ(root.getChildren().size(), 2);
+
+    root.addChild(&children[1]);
+    std::vector<Node*> order(root.getChildren().begin(), root.getChildren().end());
+    EXPECT_EQ(order, (std::vector<Node*>{&children[0], &children[2], &children[1]}));
+}
+
+TEST(NodeTest, AddingMovesChildFromItsParent) {
+    Node first;
+    Node second;
+    TestNode child;
+    first.addChild(&child);
+    second.addChild(&child);
+
+    EXPECT_TRUE(first.getChildren().empty());
+    EXPECT_EQ(second.getChildren().size(), 1);
+    EXPECT_EQ(child.getParent(), &second);
+}
+
+TEST(NodeTest, IterationSurvivesRemovingTheCurrentChild) {
+    Node root;
+    TestNode children[3];
+    for (TestNode& child : children) root.addChild(&child);
+
+    size_t visited = 0;
+    for (Node* child : root.getChildren()) {
+        root.removeChild(child);
+        ++visited;
+    }
+    EXPECT_EQ(visited, 3);
+    EXPECT_TRUE(root.getChildren().empty());
+}
+
+TEST(NodeTest, DestructionUnlinksBothWays) {
+    Node root;
+    TestNode kept;
+    root.addChild(&kept);
+    {
+        TestNode removed;
+        root.addChild(&removed);
+        TestNode grandchild;
+        removed.addChild(&grandchild);
+    }
+    ASSERT_EQ(root.getChildren().size(), 1);
+    EXPECT_EQ(root.getChildren()[0], &kept);
+
+    auto parent = std::make_unique<Node>();
+    TestNode orphan;
+    parent->addChild(&orphan);
+    parent.reset();
+    EXPECT_EQ(orphan.getParent(), nullptr);
+}
+
+TEST(NodeTest, CopiesStartDetached) {
+    Node root;
+    TestNode child;
+    TestNode grandchild;
+    root.addChild(&child);
+    child.addChild(&grandchild);
+
+    TestNode copy(child);
+    EXPECT_EQ(copy.getParent(), nullptr);
+    EXPECT_TRUE(copy.getChildren().empty());
+    EXPECT_EQ(root.getChildren().size(), 1);
+    EXPECT_EQ(grandchild.getParent(), &child);
+}
+
+TEST(NodeTest, DirectSetParentKeepsListsConsistent) {
+    Node first;
+    Node second;
+    TestNode sibling;
+    first.addChild(&sibling);
+    {
+        ReparentingTestNode child;
+        first.addChild(&child);
+        child.setParent(&second);
+        EXPECT_EQ(first.getChildren().size(), 1);
+        ASSERT_EQ(second.getChildren().size(), 1);
+        EXPECT_EQ(second.getChildren()[0], &child);
+    }
+    // Destroying it unlinked it from the parent it was moved to only
+    EXPECT_TRUE(second.getChildren().empty());
+    ASSERT_EQ(first.getChildren().size(), 1);
+    EXPECT_EQ(first.getChildren()[0], &sibling);
+
+    ReparentingTestNode orphan;
+    first.addChild(&orphan);
+    orphan.setParent(nullptr);
+    EXPECT_EQ(first.getChildren().size(), 1);
+    EXPECT_EQ(orphan.getParent(), nullptr);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <RaeptorCogs/PagedBuffer.hpp>
+#include <numeric>
+
+using namespace RaeptorCogs;
+
+TEST(PagedBufferTest, PageSizeIsPowerOfTwoWithinPageBytes) {
+    using Buffer = PagedBuffer<float>;
+    EXPECT_EQ(Buffer::PAGE_SIZE, 16384);
+    struct Wide { char bytes[96]; };
+    EXPECT_EQ(PagedBuffer<Wide>::PAGE_SIZE, 512);
+    EXPECT_LE(PagedBuffer<Wide>::PAGE_SIZE * sizeof(Wide), 1u << 16);
+}
+
+TEST(PagedBufferTest, GrowingKeepsReferencesValid) {
+    PagedBuffer<int, 64> buffer;
+    buffer.resize(3);
+    buffer[1] = 42;
+    int* element = &buffer[1];
+
+    buffer.resize(10000);
+    EXPECT_EQ(element, &buffer[1]);
+    EXPECT_EQ(*element, 42);
+    EXPECT_EQ(buffer[9999], 0);
+    EXPECT_EQ(buffer.pageCount(), (10000 + buffer.PAGE_SIZE - 1) / buffer.PAGE_SIZE);
+}
+
+TEST(PagedBufferTest, RegrowingResetsStaleElements) {
+    PagedBuffer<int, 64> buffer;
+    buffer.resize(20);
+    for (size_t i = 0; i < buffer.size(); ++i) buffer[i] = 7;
+    buffer.resize(5);
+    buffer.resize(20);
+    EXPECT_EQ(buffer[4], 7);
+    EXPECT_EQ(buffer[5], 0);
+    EXPECT_EQ(buffer[19], 0);
+}
+
+TEST(PagedBufferTest, SpansSplitAtPageBoundaries) {
+    PagedBuffer<int, 64> buffer; // 16 ints per page
+    buffer.resize(50);
+    for (size_t i = 0; i < buffer.size(); ++i) buffer[i] = static_cast<int>(i);
+
+    std::vector<std::pair<size_t, size_t>> spans;
+    buffer.forEachSpan(10, 40, [&](size_t first, const int* data, size_t count) {
+        EXPECT_EQ(*data, static_cast<int>(first));
+        spans.emplace_back(first, count);
+    });
+    EXPECT_EQ(spans, (std::vector<std::pair<size_t, size_t>>{{10, 6}, {16, 16}, {32, 8}}));
+
+    std::vector<int> flat(60, -1);
+    buffer.copy(5, 60, flat.data());
+    for (size_t i = 0; i < 45; ++i) EXPECT_EQ(flat[i], static_cast<int>(i + 5));
+    EXPECT_EQ(flat[45], -1); // Clamped to size()
+}
+
+TEST(PagedBufferTest, CrossesPage) {
+    using Buffer = PagedBuffer<int, 64>;
+    EXPECT_FALSE(Buffer::crossesPage(0, 16));
+    EXPECT_TRUE(Buffer::crossesPage(14, 4));
+    EXPECT_FALSE(Buffer::crossesPage(16, 4));
+    EXPECT_FALSE(Buffer::crossesPage(15, 0));
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <RaeptorCogs/Region.hpp>
+#include <random>
 
 using namespace RaeptorCogs;
 
@@ -61,6 +62,18 @@ TEST(RegionBufferTest, MergeOverlappingRegions) {
     EXPECT_EQ(region.second, 1024);
 }
 
+TEST(RegionBufferTest, OneElementGapIsNotMerged) {
+    RegionBuffer buffer;
+    buffer.push(0, 1);
+    buffer.push(2, 3); // Element 1 is still in use
+
+    EXPECT_EQ(buffer.size(), 2);
+    RegionAllocator allocator;
+    allocator.free(0, 1);
+    allocator.free(2, 3);
+    EXPECT_EQ(allocator.allocate(2), SIZE_MAX);
+}
+
 TEST(RegionBufferTest, MergeMultipleRegions) {
     RegionBuffer buffer;
     buffer.push(0, 100);
@@ -219,3 +232,160 @@ TEST(RegionBufferTest, ComplexScenario) {
     EXPECT_EQ(it->first, 600);
     EXPECT_EQ(it->second, 700);
 }
+
+TEST(CoalesceRegionsTest, SortsAndMergesOverlapping) {
+    std::vector<Region> regions = {{40, 50}, {0, 10}, {5, 20}, {20, 25}, {45, 60}};
+    CoalesceRegions(regions);
+
+    EXPECT_EQ(regions, (std::vector<Region>{{0, 25}, {40, 60}}));
+}
+
+TEST(CoalesceRegionsTest, BridgesSmallGaps) {
+    std::vector<Region> regions = {{30, 31}, {0, 10}, {12, 20}, {100, 110}};
+    CoalesceRegions(regions, 10);
+
+    EXPECT_EQ(regions, (std::vector<Region>{{0, 31}, {100, 110}}));
+}
+
+TEST(CoalesceRegionsTest, DenseChangesBecomeOneRange) {
+    std::vector<Region> regions;
+    for (size_t i = 1000; i > 0; --i) {
+        if (i % 3) regions.emplace_back(i, i + 1);
+    }
+    CoalesceRegions(regions, 2);
+
+    EXPECT_EQ(regions, (std::vector<Region>{{1, 1001}}));
+}
+
+TEST(CoalesceRegionsTest, EmptyStaysEmpty) {
+    std::vector<Region> regions;
+    CoalesceRegions(regions, 4);
+    EXPECT_TRUE(regions.empty());
+}
+
+TEST(RegionAllocatorTest, AllocatesFromFreedSpace) {
+    RegionAllocator allocator;
+    EXPECT_TRUE(allocator.empty());
+    EXPECT_EQ(allocator.allocate(4), SIZE_MAX);
+
+    allocator.free(0, 100);
+    EXPECT_EQ(allocator.getFreeSize(), 100);
+    size_t offset = allocator.allocate(30);
+    ASSERT_NE(offset, SIZE_MAX);
+    EXPECT_LE(offset + 30, 100);
+    EXPECT_EQ(allocator.getFreeSize(), 70);
+    EXPECT_EQ(allocator.allocate(71), SIZE_MAX);
+    EXPECT_EQ(allocator.allocate(0), SIZE_MAX);
+}
+
+TEST(RegionAllocatorTest, FreeMergesWithNeighbours) {
+    RegionAllocator allocator;
+    allocator.free(0, 10);
+    allocator.free(20, 30);
+    EXPECT_EQ(allocator.size(), 2);
+
+    allocator.free(10, 20); // Bridges both
+    EXPECT_EQ(allocator.size(), 1);
+    EXPECT_EQ(allocator.allocate(30), 0);
+    EXPECT_TRUE(allocator.empty());
+}
+
+TEST(RegionAllocatorTest, TrimDropsTheTail) {
+    RegionAllocator allocator;
+    allocator.free(10, 20);
+    allocator.free(30, 40);
+
+    EXPECT_EQ(allocator.trim(40), 30);
+    EXPECT_EQ(allocator.trim(30), 30); // [10, 20) does not end there
+    EXPECT_EQ(allocator.size(), 1);
+}
+
+TEST(RegionAllocatorTest, LargeSizesFindAFittingRegion) {
+    RegionAllocator allocator;
+    // Sizes within one first level class, only the largest fits
+    allocator.free(0, 1000);
+    allocator.free(2000, 3023);
+    allocator.free(4000, 5100);
+    EXPECT_EQ(allocator.allocate(1090), 4000);
+    EXPECT_EQ(allocator.allocate(1 << 20), SIZE_MAX);
+}
+
+TEST(RegionAllocatorTest, RandomizedStress) {
+    constexpr size_t SPACE = 1 << 14;
+    std::mt19937 rng(2024);
+    RegionAllocator allocator;
+    allocator.free(0, SPACE);
+    std::vector<bool> used(SPACE, false);
+    std::vector<Region> live;
+
+    for (int step = 0; step < 20000; ++step) {
+        if (live.empty() || rng() % 2) {
+            size_t size = 1 + (rng() % 4 == 0 ? rng() % 300 : rng() % 5);
+            size_t offset = allocator.allocate(size);
+            if (offset == SIZE_MAX) continue;
+            ASSERT_LE(offset + size, SPACE);
+            for (size_t i = offset; i < offset + size; ++i) {
+                ASSERT_FALSE(used[i]) << "overlap at " << i;
+                used[i] = true;
+            }
+            live.emplace_back(offset, offset + size);
+        } else {
+            size_t pick = rng() % live.size();
+            Region region = live[pick];
+            live[pick] = live.back();
+            live.pop_back();
+            for (size_t i = region.first; i < region.second; ++i) used[i] = false;
+            allocator.free(region.first, region.second);
+        }
+        size_t usedCount = static_cast<size_t>(std::count(used.begin(), used.end(), true));
+        ASSERT_EQ(allocator.getFreeSize(), SPACE - usedCount);
+    }
+
+    // Freeing everything coalesces back into a single region
+    for (auto [begin, end] : live) allocator.free(begin, end);
+    EXPECT_EQ(allocator.size(), 1);
+    EXPECT_EQ(allocator.allocate(SPACE), 0);
+}
+
+TEST(DirtyRegionsTest, DistantChangesStaySeparate) {
+    DirtyRegions dirty;
+    EXPECT_TRUE(dirty.empty());
+    dirty.mark(90000, 90002);
+    dirty.mark(10, 12);
+    dirty.mark(11, 13); // Extends the last range
+
+    EXPECT_EQ(dirty.getBounds(100000), Region(10, 90002));
+    EXPECT_EQ(dirty.resolve(100000, 64, 0.5), (std::vector<Region>{{10, 13}, {90000, 90002}}));
+
+    dirty.clear();
+    EXPECT_TRUE(dirty.empty());
+    EXPECT_EQ(dirty.getBounds(100000), Region(0, 0));
+}
+
+TEST(DirtyRegionsTest, SmallGapsAreBridged) {
+    DirtyRegions dirty;
+    dirty.mark(0, 10);
+    dirty.mark(40, 50);
+    dirty.mark(1000, 1001);
+    EXPECT_EQ(dirty.resolve(100000, 64, 0.5), (std::vector<Region>{{0, 50}, {1000, 1001}}));
+}
+
+TEST(DirtyRegionsTest, DenseChangesUploadEverything) {
+    DirtyRegions dirty;
+    for (size_t i = 0; i < 1000; i += 3) dirty.mark(i, i + 1);
+    EXPECT_EQ(dirty.resolve(1000, 0, 0.3), (std::vector<Region>{{0, 1000}}));
+}
+
+TEST(DirtyRegionsTest, RangesAreClippedToTheSize) {
+    DirtyRegions dirty;
+    dirty.mark(90, 120);
+    dirty.mark(200, 210);
+    EXPECT_EQ(dirty.getBounds(100), Region(90, 100));
+    EXPECT_EQ(dirty.resolve(100, 0, 1.0), (std::vector<Region>{{90, 100}}));
+}
+
+TEST(DirtyRegionsTest, TooManyRangesFoldIntoTheirBounds) {
+    DirtyRegions dirty;
+    for (size_t i = 0; i <= DirtyRegions::REGION_LIMIT; ++i) dirty.mark(i * 10, i * 10 + 1);
+    EXPECT_EQ(dirty.resolve(1 << 20, 0, 1.0), (std::vector<Region>{{0, DirtyRegions::REGION_LIMIT * 10 + 1}}));
+}
@@ -0,0 +1,498 @@
+#include <gtest/gtest.h>
+#include <RaeptorCogs/GAPI/Common/Core/RenderList.hpp>
+#include <random>
+#include <stdexcept>
+
+using namespace RaeptorCogs;
+using namespace RaeptorCogs::GAPI::Common;
+
+namespace {
+
+BatchKey keyWithZ(float z, uint32_t texture = 1) {
+    return BatchKey(false, 0, z, false, 0, texture);
+}
+
+BatchBuffer makeBatch(const std::vector<float>& zindices) {
+    BatchBuffer batch;
+    for (float z : zindices) {
+        batch.emplace_back(keyWithZ(z), nullptr);
+    }
+    return batch;
+}
+
+std::vector<unsigned int> orderOf(RenderList& list) {
+    std::vector<unsigned int> order;
+    for (auto [index, handler] : list) {
+        order.push_back(static_cast<unsigned int>(&handler - &list.getHandler(0)));
+    }
+    return order;
+}
+
+const BatchKey& keyAt(BatchBuffer& batch, RenderList& list, size_t slot) {
+    return batch.getKey(batch.indexOf(list.getIndirectHandler(slot)));
+}
+
+void expectConsistent(RenderList& list) {
+    for (size_t slot = 0; slot < list.size(); ++slot) {
+        unsigned int index = static_cast<unsigned int>(&list.getIndirectHandler(slot) - &list.getHandler(0));
+        EXPECT_EQ(list.getPosition(index), slot);
+    }
+}
+
+}
+
+TEST(RenderListTest, InsertKeepsPositions) {
+    BatchBuffer batch = makeBatch({0.0f, 1.0f, 2.0f});
+    RenderList list(batch);
+    list.insert(0);
+    list.insert(1);
+    list.insert(2);
+
+    EXPECT_EQ(list.size(), 3);
+    EXPECT_FALSE(list.needsReorder());
+    EXPECT_EQ(list.getPosition(0), 0);
+    EXPECT_EQ(list.getPosition(1), 1);
+    EXPECT_EQ(list.getPosition(2), 2);
+    EXPECT_FALSE(list.contains(3));
+}
+
+TEST(RenderListTest, OutOfOrderInsertNeedsReorder) {
+    BatchBuffer batch = makeBatch({5.0f, 1.0f, 3.0f});
+    RenderList list(batch);
+    list.insert(0);
+    list.insert(1);
+    list.insert(2);
+    ASSERT_TRUE(list.needsReorder());
+
+    list.reorder();
+    EXPECT_EQ(orderOf(list), (std::vector<unsigned int>{1, 2, 0}));
+    expectConsistent(list);
+}
+
+TEST(RenderListTest, RemoveLeavesTombstoneUntilCompaction) {
+    BatchBuffer batch = makeBatch({0.0f, 1.0f, 2.0f, 3.0f});
+    RenderList list(batch);
+    for (unsigned int i = 0; i < 4; ++i) list.insert(i);
+
+    list.remove(1);
+    list.remove(2);
+    EXPECT_TRUE(list.needsCompaction());
+    EXPECT_FALSE(list.contains(1));
+    EXPECT_FALSE(list.empty());
+    EXPECT_EQ(list.size(), 4);
+
+    list.compact();
+    EXPECT_FALSE(list.needsCompaction());
+    EXPECT_EQ(orderOf(list), (std::vector<unsigned int>{0, 3}));
+    expectConsistent(list);
+}
+
+TEST(RenderListTest, IterationSkipsTombstones) {
+    BatchBuffer batch = makeBatch({0.0f, 1.0f, 2.0f, 3.0f});
+    RenderList list(batch);
+    for (unsigned int i = 0; i < 4; ++i) list.insert(i);
+
+    list.remove(0);
+    list.remove(2);
+    list.remove(3);
+    EXPECT_EQ(orderOf(list), (std::vector<unsigned int>{1}));
+    EXPECT_EQ(&list.getIndirectHandler(1), &list.getHandler(1));
+    EXPECT_THROW(list.getIndirectHandler(0), std::runtime_error);
+    EXPECT_THROW(list.getIndirectHandler(4), std::runtime_error);
+}
+
+TEST(RenderListTest, RemoveTwiceIsHarmless) {
+    BatchBuffer batch = makeBatch({0.0f, 1.0f});
+    RenderList list(batch);
+    list.insert(0);
+    list.insert(1);
+
+    list.remove(0);
+    list.remove(0);
+    list.compact();
+    EXPECT_EQ(orderOf(list), (std::vector<unsigned int>{1}));
+}
+
+TEST(RenderListTest, RemovingEverythingEmptiesTheList) {
+    BatchBuffer batch = makeBatch({0.0f, 1.0f, 2.0f});
+    RenderList list(batch);
+    for (unsigned int i = 0; i < 3; ++i) list.insert(i);
+    for (unsigned int i = 0; i < 3; ++i) list.remove(i);
+
+    EXPECT_TRUE(list.empty());
+    list.compact();
+    EXPECT_EQ(list.size(), 0);
+}
+
+TEST(RenderListTest, ReinsertAfterRemove) {
+    BatchBuffer batch = makeBatch({0.0f, 1.0f, 2.0f});
+    RenderList list(batch);
+    for (unsigned int i = 0; i < 3; ++i) list.insert(i);
+
+    list.remove(0);
+    list.insert(0);
+    EXPECT_TRUE(list.needsReorder());
+    list.reorder();
+    EXPECT_EQ(orderOf(list), (std::vector<unsigned int>{0, 1, 2}));
+    expectConsistent(list);
+}
+
+TEST(RenderListTest, ReorderAfterKeyChanges) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> z(-100.0f, 100.0f);
+    std::vector<float> zindices(2000);
+    for (auto& value : zindices) value = z(rng);
+    BatchBuffer batch = makeBatch(zindices);
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+    list.reorder();
+
+    // Few changes take the incremental path, many the full sort
+    for (size_t changes : {10u, 1500u}) {
+        for (size_t i = 0; i < changes; ++i) {
+            size_t index = rng() % batch.size();
+            batch.getKey(index) = keyWithZ(z(rng));
+            list.markDirty(batch[index]);
+        }
+        for (size_t i = 0; i < 5; ++i) list.remove(static_cast<unsigned int>(rng() % batch.size()));
+        list.reorder();
+
+        for (size_t slot = 1; slot < list.size(); ++slot) {
+            EXPECT_FALSE(keyAt(batch, list, slot) < keyAt(batch, list, slot - 1));
+        }
+        expectConsistent(list);
+    }
+}
+
+TEST(RenderListTest, UploadRangeCoversChangedSlots) {
+    BatchBuffer batch = makeBatch({0.0f, 1.0f, 2.0f, 3.0f});
+    RenderList list(batch);
+    EXPECT_EQ(list.getUploadRange(), Region(0, 0));
+
+    for (unsigned int i = 0; i < 4; ++i) list.insert(i);
+    EXPECT_TRUE(list.wasReordered());
+    EXPECT_EQ(list.getUploadRange(), Region(0, 4));
+
+    list.clear();
+    EXPECT_EQ(list.getUploadRange(), Region(0, 0));
+}
+
+TEST(RenderListTest, MassRemovalCompactsInOnePass) {
+    std::vector<float> zindices(10000);
+    for (size_t i = 0; i < zindices.size(); ++i) zindices[i] = static_cast<float>(i);
+    BatchBuffer batch = makeBatch(zindices);
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+
+    for (unsigned int i = 0; i < batch.size(); i += 2) list.remove(i);
+    list.compact();
+
+    ASSERT_EQ(list.size(), batch.size() / 2);
+    for (size_t slot = 0; slot < list.size(); ++slot) {
+        EXPECT_EQ(list.getPosition(static_cast<unsigned int>(slot * 2 + 1)), slot);
+    }
+    EXPECT_FALSE(list.needsCompaction());
+}
+
+TEST(RenderListTest, IncrementalReorderWithSeveralDirtyHandlers) {
+    BatchBuffer batch = makeBatch({0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f});
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+
+    // Moves in both directions while the other dirty handler is still out of place
+    batch.getKey(1) = keyWithZ(10.0f);
+    batch.getKey(4) = keyWithZ(-1.0f);
+    list.markDirty(batch[1]);
+    list.markDirty(batch[4]);
+    list.markDirty(batch[1]);
+    list.reorder();
+
+    EXPECT_EQ(orderOf(list), (std::vector<unsigned int>{4, 0, 2, 3, 5, 1}));
+    expectConsistent(list);
+}
+
+TEST(RenderListTest, IncrementalReorderStaysSorted) {
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<float> z(-50.0f, 50.0f);
+    std::vector<float> zindices(500);
+    for (auto& value : zindices) value = z(rng);
+    BatchBuffer batch = makeBatch(zindices);
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+    list.reorder();
+
+    for (int round = 0; round < 200; ++round) {
+        size_t changes = 1 + rng() % RenderList::INCREMENTAL_REORDER_LIMIT;
+        for (size_t i = 0; i < changes; ++i) {
+            size_t index = rng() % batch.size();
+            batch.getKey(index) = keyWithZ(z(rng));
+            list.markDirty(batch[index]);
+        }
+        list.reorder();
+    }
+    for (size_t slot = 1; slot < list.size(); ++slot) {
+        EXPECT_FALSE(keyAt(batch, list, slot) < keyAt(batch, list, slot - 1));
+    }
+    expectConsistent(list);
+}
+
+TEST(RenderListTest, MergeReorderMatchesFullSort) {
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> z(-1000.0f, 1000.0f);
+    std::vector<float> zindices(5000);
+    for (auto& value : zindices) value = z(rng);
+    BatchBuffer batch = makeBatch(zindices);
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+    list.reorder();
+
+    // 20% of the list, with duplicates, takes the merge path
+    for (int round = 0; round < 5; ++round) {
+        for (size_t i = 0; i < batch.size() / 5; ++i) {
+            size_t index = rng() % batch.size();
+            batch.getKey(index) = keyWithZ(z(rng));
+            list.markDirty(batch[index]);
+            list.markDirty(batch[index]);
+        }
+        list.reorder();
+
+        ASSERT_EQ(list.size(), batch.size());
+        for (size_t slot = 1; slot < list.size(); ++slot) {
+            EXPECT_FALSE(keyAt(batch, list, slot) < keyAt(batch, list, slot - 1));
+        }
+        expectConsistent(list);
+    }
+}
+
+TEST(RenderListTest, DrawCommandsRebuiltOnlyOnStructuralChange) {
+    BatchBuffer batch = makeBatch({0.0f, 1.0f, 2.0f, 3.0f});
+    batch.getKey(2) = keyWithZ(2.0f, 2);
+    batch.getKey(3) = keyWithZ(3.0f, 2);
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+
+    auto sameTexture = [](const BatchKey& a, const BatchKey& b) {
+        return a.matches(b, BatchKey::TEXTURE_FIELD);
+    };
+    ASSERT_TRUE(list.needsDrawCommandsRebuild());
+    list.buildDrawCommands(sameTexture);
+    EXPECT_FALSE(list.needsDrawCommandsRebuild());
+
+    const auto& commands = list.getDrawCommands();
+    ASSERT_EQ(commands.size(), 2);
+    EXPECT_EQ(commands[0].handlerIndex, 0);
+    EXPECT_EQ(commands[0].baseInstance, 0);
+    EXPECT_EQ(commands[0].instanceCount, 2);
+    EXPECT_EQ(commands[1].textureSlot, 2);
+    EXPECT_EQ(commands[1].baseInstance, 2);
+    EXPECT_EQ(commands[1].instanceCount, 2);
+
+    // A batch key change without any move still invalidates the commands
+    batch.getKey(1) = keyWithZ(1.0f, 2);
+    list.markDirty(batch[1]);
+    list.reorder();
+    ASSERT_TRUE(list.needsDrawCommandsRebuild());
+    list.buildDrawCommands(sameTexture);
+    ASSERT_EQ(list.getDrawCommands().size(), 2);
+    EXPECT_EQ(list.getDrawCommands()[1].baseInstance, 1);
+
+    list.remove(0);
+    list.compact();
+    EXPECT_TRUE(list.needsDrawCommandsRebuild());
+    list.buildDrawCommands(sameTexture);
+    ASSERT_EQ(list.getDrawCommands().size(), 1);
+    EXPECT_EQ(list.getDrawCommands()[0].instanceCount, 3);
+
+    // Nothing moves when the last slots go, the commands must shrink all the same
+    unsigned int last = static_cast<unsigned int>(batch.indexOf(list.getIndirectHandler(list.size() - 1)));
+    list.remove(last);
+    list.compact();
+    EXPECT_TRUE(list.needsDrawCommandsRebuild());
+    list.buildDrawCommands(sameTexture);
+    ASSERT_EQ(list.getDrawCommands().size(), 1);
+    EXPECT_EQ(list.getDrawCommands()[0].instanceCount, 2);
+}
+
+TEST(RenderListTest, RelocateKeepsOrderSlot) {
+    BatchBuffer batch = makeBatch({0.0f, 1.0f, 2.0f, 3.0f});
+    RenderList list(batch);
+    for (unsigned int i = 1; i < batch.size(); ++i) list.insert(i);
+    list.reorder();
+    list.buildDrawCommands([](const BatchKey&, const BatchKey&) { return true; });
+
+    // Handler 3 moves into the free index 0, as the defragmentation does
+    batch.move(3, 0);
+    list.relocate(3, 0);
+    EXPECT_EQ(orderOf(list), (std::vector<unsigned int>{1, 2, 0}));
+    EXPECT_FALSE(list.contains(3));
+    EXPECT_TRUE(list.needsDrawCommandsRebuild());
+    expectConsistent(list);
+
+    // A pending reorder follows the handler to its new index
+    batch.getKey(0) = keyWithZ(-1.0f);
+    list.markDirty(batch[0]);
+    batch.move(0, 3);
+    list.relocate(0, 3);
+    list.reorder();
+    EXPECT_EQ(orderOf(list), (std::vector<unsigned int>{3, 1, 2}));
+    expectConsistent(list);
+}
+
+TEST(RenderListTest, IndirectionCapacityGrowsAndShrinksGeometrically) {
+    constexpr size_t MIN = RenderList::MIN_INDIRECTION_CAPACITY;
+    EXPECT_EQ(RenderList::GetIndirectionCapacity(0, 0), MIN);
+    EXPECT_EQ(RenderList::GetIndirectionCapacity(0, 10), MIN);
+    EXPECT_EQ(RenderList::GetIndirectionCapacity(MIN, MIN + 1), MIN * 2);
+    EXPECT_EQ(RenderList::GetIndirectionCapacity(MIN, 10 * MIN), MIN * 16);
+
+    // No reallocation while the size stays above a quarter of the capacity
+    EXPECT_EQ(RenderList::GetIndirectionCapacity(MIN * 16, MIN * 4), MIN * 16);
+    EXPECT_EQ(RenderList::GetIndirectionCapacity(MIN * 16, MIN * 4 - 1), MIN * 8);
+    EXPECT_EQ(RenderList::GetIndirectionCapacity(MIN * 16, 0), MIN);
+}
+
+TEST(RenderListTest, UploadRegionsMergeInsertsIntoOneRange) {
+    BatchBuffer batch = makeBatch(std::vector<float>(10000, 0.0f));
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+    EXPECT_EQ(list.getUploadRegions(), (std::vector<Region>{{0, batch.size()}}));
+
+    // Compaction shortens the list below the pending range
+    for (unsigned int i = 5000; i < batch.size(); ++i) list.remove(i);
+    list.compact();
+    EXPECT_EQ(list.getUploadRegions(), (std::vector<Region>{{0, 5000}}));
+}
+
+TEST(RenderListTest, NearlySortedReorderMatchesFullSort) {
+    std::vector<float> zindices(100000);
+    for (size_t i = 0; i < zindices.size(); ++i) zindices[i] = static_cast<float>(i);
+    BatchBuffer batch = makeBatch(zindices);
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+    list.reorder();
+
+    // Many small nudges, some crossing each other, take the local path
+    std::mt19937 rng(12);
+    std::uniform_real_distribution<float> jitter(-3.0f, 3.0f);
+    for (size_t i = 0; i < 5000; ++i) {
+        size_t index = rng() % batch.size();
+        batch.getKey(index) = keyWithZ(static_cast<float>(index) + jitter(rng));
+        list.markDirty(batch[index]);
+    }
+    list.reorder();
+
+    RenderList sorted(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) sorted.insert(i);
+    sorted.reorder();
+    for (size_t slot = 0; slot < list.size(); ++slot) {
+        ASSERT_EQ(keyAt(batch, list, slot), keyAt(batch, sorted, slot));
+    }
+    expectConsistent(list);
+}
+
+TEST(RenderListTest, MisjudgedLocalReorderFallsBack) {
+    std::vector<float> zindices(10000);
+    for (size_t i = 0; i < zindices.size(); ++i) zindices[i] = static_cast<float>(i);
+    BatchBuffer batch = makeBatch(zindices);
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+    list.reorder();
+
+    // Sampled handlers keep their key, the others jump across the whole list
+    for (unsigned int i = 0; i < 320; ++i) {
+        unsigned int index = i * 31;
+        if (i % 10) batch.getKey(index) = keyWithZ(static_cast<float>(batch.size() - index));
+        list.markDirty(batch[index]);
+    }
+    list.reorder();
+
+    for (size_t slot = 1; slot < list.size(); ++slot) {
+        EXPECT_FALSE(keyAt(batch, list, slot) < keyAt(batch, list, slot - 1));
+    }
+    expectConsistent(list);
+}
+
+namespace {
+
+void expectBucketsConsistent(BatchBuffer& batch, RenderList& list, float zRange) {
+    const auto& buckets = list.getBuckets();
+    size_t slot = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        ASSERT_EQ(buckets[i].begin, slot);
+        ASSERT_LT(buckets[i].begin, buckets[i].end);
+        if (i > 0) {
+            ASSERT_LT(buckets[i - 1].key, buckets[i].key);
+        }
+        for (; slot < buckets[i].end; ++slot) {
+            ASSERT_EQ(RenderList::GetBucketKey(keyAt(batch, list, slot), zRange), buckets[i].key);
+        }
+    }
+    EXPECT_EQ(slot, list.size());
+    expectConsistent(list);
+}
+
+}
+
+TEST(RenderListTest, BucketedLayerSwitchesKeepBucketsContiguous) {
+    // Four layers of handlers cycling over four textures
+    BatchBuffer batch;
+    for (size_t i = 0; i < 4000; ++i) {
+        batch.emplace_back(keyWithZ(static_cast<float>(i % 4), static_cast<uint32_t>(1 + i % 7 % 4)), nullptr);
+    }
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+    list.setBucketed(true);
+    ASSERT_TRUE(list.isBucketed());
+    EXPECT_EQ(list.getBuckets().size(), 16);
+    expectBucketsConsistent(batch, list, 0.0f);
+
+    std::mt19937 rng(20);
+    for (size_t frame = 0; frame < 8; ++frame) {
+        for (size_t i = 0; i < 50; ++i) {
+            size_t index = rng() % batch.size();
+            batch.getKey(index) = keyWithZ(static_cast<float>(rng() % 5), static_cast<uint32_t>(1 + rng() % 4));
+            list.markDirty(batch[index]);
+        }
+        list.reorder();
+        expectBucketsConsistent(batch, list, 0.0f);
+    }
+
+    // Handlers come and go without tombstones
+    for (unsigned int i = 0; i < 1000; ++i) list.remove(i * 3);
+    EXPECT_FALSE(list.needsCompaction());
+    EXPECT_EQ(list.size(), 3000);
+    list.insert(0);
+    EXPECT_TRUE(list.contains(0));
+    expectBucketsConsistent(batch, list, 0.0f);
+
+    // Leaving the bucketed mode sorts the list again
+    list.setBucketed(false);
+    EXPECT_TRUE(list.getBuckets().empty());
+    for (size_t slot = 1; slot < list.size(); ++slot) {
+        EXPECT_FALSE(keyAt(batch, list, slot) < keyAt(batch, list, slot - 1));
+    }
+}
+
+TEST(RenderListTest, BucketedZRangesOrderOnlyByTexture) {
+    BatchBuffer batch;
+    batch.emplace_back(keyWithZ(0.5f, 2), nullptr);
+    batch.emplace_back(keyWithZ(0.1f, 3), nullptr);
+    batch.emplace_back(keyWithZ(0.9f, 1), nullptr);
+    batch.emplace_back(keyWithZ(1.2f, 1), nullptr);
+    RenderList list(batch);
+    for (unsigned int i = 0; i < batch.size(); ++i) list.insert(i);
+    list.setBucketed(true, 1.0f);
+
+    EXPECT_EQ(orderOf(list), (std::vector<unsigned int>{2, 0, 1, 3}));
+    EXPECT_EQ(list.getBuckets().size(), 4);
+
+    // Moving within the range keeps the bucket, leaving it switches layers
+    batch.getKey(1) = keyWithZ(0.7f, 3);
+    list.markDirty(batch[1]);
+    batch.getKey(2) = keyWithZ(1.5f, 1);
+    list.markDirty(batch[2]);
+    list.reorder();
+    EXPECT_EQ(orderOf(list), (std::vector<unsigned int>{0, 1, 2, 3}));
+    EXPECT_EQ(list.getBuckets().size(), 3);
+    expectBucketsConsistent(batch, list, 1.0f);
+}
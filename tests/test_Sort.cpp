@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <RaeptorCogs/Sort.hpp>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace RaeptorCogs;
+
+namespace {
+
+std::vector<unsigned int> stableReference(const std::vector<uint64_t>& keys) {
+    std::vector<unsigned int> order(keys.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&keys](unsigned int a, unsigned int b) {
+        return keys[a] < keys[b];
+    });
+    return order;
+}
+
+std::vector<unsigned int> radixSorted(RadixSorter& sorter, const std::vector<uint64_t>& keys) {
+    std::vector<unsigned int> order(keys.size());
+    std::iota(order.begin(), order.end(), 0u);
+    sorter.sort(order, [&keys](unsigned int index) { return keys[index]; });
+    return order;
+}
+
+}
+
+TEST(RadixSorterTest, EmptyAndSingle) {
+    RadixSorter sorter;
+    std::vector<unsigned int> empty;
+    sorter.sort(empty, [](unsigned int) { return uint64_t{0}; });
+    EXPECT_TRUE(empty.empty());
+
+    std::vector<unsigned int> single = {7};
+    sorter.sort(single, [](unsigned int) { return uint64_t{42}; });
+    ASSERT_EQ(single.size(), 1);
+    EXPECT_EQ(single[0], 7);
+}
+
+TEST(RadixSorterTest, MatchesStableSortOnRandomKeys) {
+    RadixSorter sorter;
+    std::mt19937_64 rng(1234);
+    std::vector<uint64_t> keys(5000);
+    for (auto& key : keys) key = rng();
+
+    EXPECT_EQ(radixSorted(sorter, keys), stableReference(keys));
+}
+
+TEST(RadixSorterTest, IsStableWithDuplicateKeys) {
+    RadixSorter sorter;
+    std::mt19937_64 rng(99);
+    std::vector<uint64_t> keys(4096);
+    for (auto& key : keys) key = (rng() % 8) << 40;
+
+    EXPECT_EQ(radixSorted(sorter, keys), stableReference(keys));
+}
+
+TEST(RadixSorterTest, AllEqualKeysKeepOrder) {
+    RadixSorter sorter;
+    std::vector<uint64_t> keys(100, 0xDEADBEEFull);
+
+    EXPECT_EQ(radixSorted(sorter, keys), stableReference(keys));
+}
+
+TEST(RadixSorterTest, ReusedAcrossSizes) {
+    RadixSorter sorter;
+    std::mt19937_64 rng(5);
+    for (size_t size : {1000u, 10u, 3000u, 0u, 257u}) {
+        std::vector<uint64_t> keys(size);
+        for (auto& key : keys) key = rng() >> (rng() % 64);
+        EXPECT_EQ(radixSorted(sorter, keys), stableReference(keys));
+    }
+}
+
+TEST(RadixSorterTest, SortsPrecomputedKeys) {
+    RadixSorter sorter;
+    std::vector<uint64_t> keys = {5, 1, 4, 1, 3};
+    std::vector<unsigned int> values = {0, 1, 2, 3, 4};
+    sorter.sort(keys, values);
+
+    EXPECT_EQ(keys, (std::vector<uint64_t>{1, 1, 3, 4, 5}));
+    EXPECT_EQ(values, (std::vector<unsigned int>{1, 3, 4, 2, 0}));
+}
+
+TEST(RadixSorterTest, ParallelMatchesSerial) {
+    std::mt19937_64 rng(77);
+    for (size_t size : {5u, 1000u, 20000u}) {
+        std::vector<uint64_t> keys(size);
+        // Few distinct high digits to exercise stability across chunks
+        for (auto& key : keys) key = ((rng() % 16) << 48) | (rng() & 0xFFFF);
+
+        RadixSorter serial;
+        serial.setThreadCount(1);
+        auto expected = radixSorted(serial, keys);
+        EXPECT_EQ(expected, stableReference(keys));
+
+        for (unsigned int threads : {2u, 3u, 8u}) {
+            RadixSorter parallel;
+            parallel.setThreadCount(threads);
+            parallel.setParallelThreshold(0);
+            EXPECT_EQ(radixSorted(parallel, keys), expected) << "size=" << size << " threads=" << threads;
+        }
+    }
+}
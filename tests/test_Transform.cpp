@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <RaeptorCogs/Transform.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+
+using namespace RaeptorCogs;
+
+namespace {
+
+void expectAffineNear(const Affine2D& actual, const Affine2D& expected) {
+    EXPECT_NEAR(actual.a, expected.a, 1e-5f);
+    EXPECT_NEAR(actual.b, expected.b, 1e-5f);
+    EXPECT_NEAR(actual.c, expected.c, 1e-5f);
+    EXPECT_NEAR(actual.d, expected.d, 1e-5f);
+    EXPECT_NEAR(actual.tx, expected.tx, 1e-4f);
+    EXPECT_NEAR(actual.ty, expected.ty, 1e-4f);
+    EXPECT_NEAR(actual.tz, expected.tz, 1e-5f);
+}
+
+void expectAffineEq(const Affine2D& actual, const Affine2D& expected) {
+    EXPECT_EQ(actual.a, expected.a);
+    EXPECT_EQ(actual.b, expected.b);
+    EXPECT_EQ(actual.c, expected.c);
+    EXPECT_EQ(actual.d, expected.d);
+    EXPECT_EQ(actual.tx, expected.tx);
+    EXPECT_EQ(actual.ty, expected.ty);
+    EXPECT_EQ(actual.tz, expected.tz);
+}
+
+TransformComponents makeComponents(int i) {
+    TransformComponents components;
+    components.position = glm::vec2(static_cast<float>(i * 37 % 101) - 50.0f, static_cast<float>(i * 13 % 29) * 0.5f);
+    components.size = glm::vec2(1.0f + static_cast<float>(i % 9) * 7.5f, 3.25f + static_cast<float>(i % 4));
+    components.scale = glm::vec2(0.5f + static_cast<float>(i % 3) * 0.75f, 1.0f / static_cast<float>(1 + i % 5));
+    components.rotation = i < 16 ? 0.0f : 0.37f * static_cast<float>(i % 11) - 1.5f;
+    components.anchor = glm::vec2(static_cast<float>(i % 5) * 0.25f, 1.0f / 3.0f);
+    components.depth = static_cast<float>(i) / 1000.0f;
+    return components;
+}
+
+}
+
+TEST(TransformTest, LocalAffineRotatesScalesAroundAnchor) {
+    TransformComponents components;
+    components.position = glm::vec2(10.0f, 20.0f);
+    components.size = glm::vec2(2.0f, 4.0f);
+    components.scale = glm::vec2(3.0f, 1.0f);
+    components.rotation = 1.57079632679f;
+    components.anchor = glm::vec2(0.5f, 0.5f);
+    components.depth = 0.25f;
+
+    // Quarter turn: x goes to y, y to -x, the anchor stays on the position
+    Affine2D expected;
+    expected.a = 0.0f;
+    expected.b = 6.0f;
+    expected.c = -4.0f;
+    expected.d = 0.0f;
+    expected.tx = 10.0f + 2.0f;
+    expected.ty = 20.0f - 3.0f;
+    expected.tz = 0.25f;
+    expectAffineNear(ComposeLocalAffine(components), expected);
+}
+
+TEST(TransformTest, LocalAffineMatchesGlmChain) {
+    for (int i = 0; i < 32; ++i) {
+        TransformComponents components = makeComponents(i);
+        glm::mat4 matrix(1.0f);
+        matrix = glm::translate(matrix, glm::vec3(components.position, 0.0f));
+        matrix = glm::rotate(matrix, components.rotation, glm::vec3(0.0f, 0.0f, 1.0f));
+        matrix = glm::scale(matrix, glm::vec3(components.size, 1.0f));
+        matrix = glm::scale(matrix, glm::vec3(components.scale, 1.0f));
+        matrix = glm::translate(matrix, glm::vec3(-components.anchor, 0.0f));
+
+        Affine2D expected;
+        expected.a = matrix[0][0];
+        expected.b = matrix[0][1];
+        expected.c = matrix[1][0];
+        expected.d = matrix[1][1];
+        expected.tx = matrix[3][0];
+        expected.ty = matrix[3][1];
+        expected.tz = components.depth;
+        expectAffineEq(ComposeLocalAffine(components), expected);
+    }
+}
+
+TEST(TransformTest, BatchedLocalAffinesMatchScalarOnes) {
+    // Unrotated then rotated transforms, with a tail shorter than a batch
+    TransformComponentArrays arrays;
+    for (int i = 0; i < 43; ++i) arrays.push(makeComponents(i));
+    std::vector<uint32_t> all(arrays.size());
+    std::vector<uint32_t> odd;
+    for (uint32_t i = 0; i < all.size(); ++i) {
+        all[i] = i;
+        if (i % 2) odd.push_back(i);
+    }
+
+    for (const std::vector<uint32_t>* indices : {&all, &odd}) {
+        std::vector<Affine2D> locals(arrays.size());
+        ComposeLocalAffines(arrays, indices->data(), indices->size(), locals.data());
+        for (uint32_t index : *indices) {
+            expectAffineEq(locals[index], ComposeLocalAffine(arrays.get(index)));
+        }
+    }
+}
+
+TEST(TransformTest, ChildrenArePlacedFromTheParentAnchor) {
+    TransformHierarchy hierarchy;
+    TransformID parent = hierarchy.create();
+    TransformID child = hierarchy.create();
+    hierarchy.setParent(child, parent);
+
+    hierarchy.setPosition(parent, glm::vec2(100.0f, 50.0f));
+    hierarchy.setSize(parent, glm::vec2(10.0f, 20.0f));
+    hierarchy.setAnchor(parent, glm::vec2(0.5f, 0.5f));
+    hierarchy.setDepth(parent, 1.0f);
+    hierarchy.setPosition(child, glm::vec2(0.25f, -0.5f));
+    hierarchy.setDepth(child, 0.5f);
+
+    // The parent size does not scale its children
+    Affine2D expected;
+    expected.tx = 100.0f + 0.25f;
+    expected.ty = 50.0f - 0.5f;
+    expected.tz = 1.5f;
+    expectAffineNear(hierarchy.getGlobal(child), expected);
+    EXPECT_FALSE(hierarchy.needsUpdate());
+
+    // Moving the parent alone moves the child
+    hierarchy.setPosition(parent, glm::vec2(0.0f, 0.0f));
+    expected.tx = 0.25f;
+    expected.ty = -0.5f;
+    expectAffineNear(hierarchy.getGlobal(child), expected);
+}
+
+TEST(TransformTest, ReparentingKeepsParentsFirst) {
+    TransformHierarchy hierarchy;
+    TransformID leaf = hierarchy.create();
+    TransformID middle = hierarchy.create();
+    TransformID root = hierarchy.create();
+    hierarchy.setParent(leaf, middle);
+    hierarchy.setParent(middle, root);
+    hierarchy.setPosition(root, glm::vec2(5.0f, 0.0f));
+    hierarchy.setPosition(middle, glm::vec2(0.0f, 3.0f));
+
+    hierarchy.update();
+    EXPECT_LT(hierarchy.getSlot(root), hierarchy.getSlot(middle));
+    EXPECT_LT(hierarchy.getSlot(middle), hierarchy.getSlot(leaf));
+    EXPECT_EQ(hierarchy.getParent(leaf), middle);
+    EXPECT_EQ(hierarchy.getParent(root), TransformHierarchy::NO_TRANSFORM);
+    EXPECT_NEAR(hierarchy.getGlobal(leaf).tx, 5.0f, 1e-5f);
+    EXPECT_NEAR(hierarchy.getGlobal(leaf).ty, 3.0f, 1e-5f);
+
+    // Detached, the leaf drops its ancestors' translation
+    hierarchy.setParent(leaf, TransformHierarchy::NO_TRANSFORM);
+    EXPECT_NEAR(hierarchy.getGlobal(leaf).tx, 0.0f, 1e-5f);
+    EXPECT_NEAR(hierarchy.getGlobal(leaf).ty, 0.0f, 1e-5f);
+}
+
+TEST(TransformTest, DeepChainMatchesRecursiveComposition) {
+    TransformHierarchy hierarchy;
+    std::vector<TransformID> chain;
+    for (int i = 0; i < 64; ++i) {
+        TransformID id = hierarchy.create();
+        TransformComponents components;
+        components.position = glm::vec2(static_cast<float>(i % 5), 1.0f);
+        components.size = glm::vec2(1.0f + static_cast<float>(i % 3), 2.0f);
+        components.rotation = 0.1f * static_cast<float>(i % 7);
+        components.anchor = glm::vec2(0.5f, 0.25f);
+        hierarchy.setComponents(id, components);
+        if (!chain.empty()) hierarchy.setParent(id, chain.back());
+        chain.push_back(id);
+    }
+    hierarchy.update();
+
+    // Touching a node halfway only rebuilds its subtree
+    hierarchy.setRotation(chain[32], 0.5f);
+
+    Affine2D expected = ComposeLocalAffine(hierarchy.getComponents(chain[0]));
+    for (size_t i = 1; i < chain.size(); ++i) {
+        TransformComponents parent = hierarchy.getComponents(chain[i - 1]);
+        expected = ComposeChildAffine(expected, parent.size, parent.anchor, ComposeLocalAffine(hierarchy.getComponents(chain[i])));
+    }
+    expectAffineNear(hierarchy.getGlobal(chain.back()), expected);
+}
+
+TEST(TransformTest, DestroyedTransformsAreReused) {
+    TransformHierarchy hierarchy;
+    TransformID first = hierarchy.create();
+    TransformID second = hierarchy.create();
+    hierarchy.destroy(first);
+    EXPECT_EQ(hierarchy.getSlot(first), TransformHierarchy::NO_SLOT);
+
+    TransformID third = hierarchy.create();
+    EXPECT_EQ(third, first);
+    EXPECT_EQ(hierarchy.getComponents(third).size.x, 1.0f);
+    EXPECT_EQ(hierarchy.size(), 2);
+
+    // Mostly free arrays are compacted on the next update
+    TransformID fourth = hierarchy.create();
+    hierarchy.destroy(third);
+    hierarchy.destroy(fourth);
+    hierarchy.update();
+    EXPECT_EQ(hierarchy.size(), 1);
+    EXPECT_EQ(hierarchy.getSlot(second), 0u);
+}